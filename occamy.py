@@ -33,6 +33,7 @@ from pulp.chips.occamy.soc_reg import SocReg
 from pulp.chips.occamy.quadrant import Quadrant
 import pulp.chips.occamy.occamy_arch
 from pulp.snitch.zero_mem import ZeroMem
+from pulp.snitch.global_barrier import GlobalBarrier
 import memory.dramsys
 
 GAPY_TARGET = True
@@ -70,6 +71,9 @@ class Soc(gvsoc.systree.Component):
         for id in range(0, arch.nb_quadrant):
             quadrants.append(Quadrant(self, f'quadrant_{id}', arch.get_quadrant(id)))
 
+        # Global barrier, SoC level
+        barrier = GlobalBarrier(self, 'barrier', nb_inputs=arch.nb_quadrant, latency=arch.barrier_latency)
+
         # Extra component for binary loading
         loader = utils.loader.loader.ElfLoader(self, 'loader', binary=binary)
 
@@ -129,6 +133,11 @@ class Soc(gvsoc.systree.Component):
             quadrants[id].o_WIDE_SOC(wide_axi.i_INPUT())
             wide_axi.o_MAP ( quadrants[id].i_WIDE_INPUT(), base=arch.quadrant_base(id), size=arch.quadrant.size, rm_base=False )
 
+        # Global barrier
+        for id in range(0, arch.nb_quadrant):
+            quadrants[id].o_GLOBAL_BARRIER_REQ(barrier.i_INPUT_REQ(id))
+            barrier.o_INPUT_ACK(quadrants[id].i_GLOBAL_BARRIER_ACK())
+
         # HBM
         wide_axi.o_MAP ( self.i_HBM(), base=arch.hbm_0_alias.base, size=arch.hbm_0_alias.size, rm_base=True, latency=100 )
         narrow_axi.o_MAP ( wide_axi.i_INPUT(), base=arch.hbm_0_alias.base, size=arch.hbm_0_alias.size, rm_base=False )
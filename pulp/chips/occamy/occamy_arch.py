@@ -23,6 +23,9 @@ class OccamyArchProperties:
         self.nb_quadrant             = 6
         self.nb_cluster_per_quadrant = 4
         self.nb_core_per_cluster     = 9
+        self.quadrant_barrier_latency = 2
+        self.soc_barrier_latency     = 4
+        self.global_barrier          = 0
         self.hbm_size                = 0x80000000
         self.hbm_type                = 'simple'
 
@@ -50,6 +53,21 @@ class OccamyArchProperties:
             name='soc/quadrant/cluster/nb_core', value=self.nb_core_per_cluster, cast=int, description='Number of cores per cluster'
         )
 
+        self.quadrant_barrier_latency = target.declare_user_property(
+            name='soc/quadrant/barrier_latency', value=self.quadrant_barrier_latency, cast=int,
+            description='Cycles taken by the global barrier to cross the quadrant level'
+        )
+
+        self.soc_barrier_latency = target.declare_user_property(
+            name='soc/barrier_latency', value=self.soc_barrier_latency, cast=int,
+            description='Cycles taken by the global barrier to cross the SoC level'
+        )
+
+        self.global_barrier = target.declare_user_property(
+            name='soc/global_barrier', value=self.global_barrier, cast=int,
+            description='Set to 1 to make the cluster HW_BARRIER register wait for all clusters'
+        ) != 0
+
 
 
 
@@ -81,6 +99,7 @@ class OccamyArch:
 
             def __init__(self, properties):
                 self.nb_quadrant = properties.nb_quadrant
+                self.barrier_latency = properties.soc_barrier_latency
                 current_hartid = 0
 
                 self.debug          = Area(    0x0000_0000,     0x0000_0fff)
@@ -148,6 +167,7 @@ class OccamyArch:
         class Quadrant:
             def __init__(self, properties, base, first_hartid):
                 self.nb_cluster = properties.nb_cluster_per_quadrant
+                self.barrier_latency = properties.quadrant_barrier_latency
                 self.base = base
 
                 self.cluster  = Area(base, 0x0004_0000)
@@ -16,6 +16,7 @@
 
 import gvsoc.systree
 from pulp.snitch.snitch_cluster.snitch_cluster import SnitchCluster
+from pulp.snitch.global_barrier import GlobalBarrier
 import interco.router as router
 
 class Quadrant(gvsoc.systree.Component):
@@ -38,6 +39,9 @@ class Quadrant(gvsoc.systree.Component):
         for cid in range(0, arch.nb_cluster):
             clusters.append(SnitchCluster(self, f'cluster_{cid}', arch.get_cluster(cid)))
 
+        # Global barrier, quadrant level
+        barrier = GlobalBarrier(self, 'barrier', nb_inputs=arch.nb_cluster, latency=arch.barrier_latency)
+
         #
         # Bindings
         #
@@ -60,6 +64,12 @@ class Quadrant(gvsoc.systree.Component):
         for cid in range(0, arch.nb_cluster):
             clusters[cid].o_NARROW_SOC(narrow_axi.i_INPUT())
             clusters[cid].o_WIDE_SOC(wide_axi.i_INPUT())
+            clusters[cid].o_GLOBAL_BARRIER_REQ(barrier.i_INPUT_REQ(cid))
+            barrier.o_INPUT_ACK(clusters[cid].i_GLOBAL_BARRIER_ACK())
+
+        # Global barrier
+        barrier.o_OUTPUT_REQ(self.i_GLOBAL_BARRIER_REQ())
+        self.o_GLOBAL_BARRIER_ACK(barrier.i_OUTPUT_ACK())
 
 
 
@@ -86,3 +96,15 @@ class Quadrant(gvsoc.systree.Component):
 
     def o_WIDE_INPUT(self, itf: gvsoc.systree.SlaveItf):
         self.itf_bind('wide_input', itf, signature='io', composite_bind=True)
+
+    def i_GLOBAL_BARRIER_REQ(self) -> gvsoc.systree.SlaveItf:
+        return gvsoc.systree.SlaveItf(self, 'global_barrier_req', signature='wire<bool>')
+
+    def o_GLOBAL_BARRIER_REQ(self, itf: gvsoc.systree.SlaveItf):
+        self.itf_bind('global_barrier_req', itf, signature='wire<bool>')
+
+    def i_GLOBAL_BARRIER_ACK(self) -> gvsoc.systree.SlaveItf:
+        return gvsoc.systree.SlaveItf(self, 'global_barrier_ack', signature='wire<bool>')
+
+    def o_GLOBAL_BARRIER_ACK(self, itf: gvsoc.systree.SlaveItf):
+        self.itf_bind('global_barrier_ack', itf, signature='wire<bool>', composite_bind=True)
@@ -160,6 +160,11 @@ class Cluster(st.Component):
             self.bind(event_unit, 'clock_%d' % i, pes[i], 'clock')
             self.bind(event_unit, 'irq_req_%d' % i, pes[i], 'irq_req')
 
+        # Global barrier, only used by the event unit when one of its barriers is configured
+        # as global
+        self.bind(event_unit, 'global_barrier_req', self, 'global_barrier_req')
+        self.bind(self, 'global_barrier_ack', event_unit, 'global_barrier_ack')
+
         # Cluster interconnect
         self.bind(self, 'input', cluster_ico, 'input')
 
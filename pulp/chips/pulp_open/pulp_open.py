@@ -22,6 +22,7 @@ from utils.clock_generator import Clock_generator
 from pulp.padframe.padframe_v1 import Padframe
 import interco.router_proxy as router_proxy
 import memory.dramsys
+from pulp.snitch.global_barrier import GlobalBarrier
 
 class Pulp_open(st.Component):
 
@@ -61,6 +62,10 @@ class Pulp_open(st.Component):
             cluster_name = get_cluster_name(cid)
             clusters.append(Cluster(self, cluster_name, config_file=cluster_config_file, cid=cid))
 
+        # Global barrier between clusters
+        if nb_cluster > 1:
+            global_barrier = GlobalBarrier(self, 'global_barrier', nb_inputs=nb_cluster)
+
         # Soc
         soc = Soc(self, 'soc', parser, config_file=soc_config_file, chip=self, cluster=clusters[0])
 
@@ -126,6 +131,8 @@ class Pulp_open(st.Component):
         # Soc clock domain
         self.bind(soc_clock, 'out', soc, 'clock')
         self.bind(soc_clock, 'out', axi_proxy, 'clock')
+        if nb_cluster > 1:
+            self.bind(soc_clock, 'out', global_barrier, 'clock')
         if use_ddr:
             self.bind(soc_clock, 'out', ddr, 'clock')
 
@@ -141,6 +148,9 @@ class Pulp_open(st.Component):
             self.bind(soc, get_cluster_name(cid) + '_fll', cluster_clocks[cid], 'clock_in')
             self.bind(soc, get_cluster_name(cid) + '_input', clusters[cid], 'input')
             self.bind(clusters[cid], 'soc', soc, 'soc_input')
+            if nb_cluster > 1:
+                self.bind(clusters[cid], 'global_barrier_req', global_barrier, 'input_req_%d' % cid)
+                self.bind(global_barrier, 'input_ack', clusters[cid], 'global_barrier_ack')
 
         # Soc
         self.bind(soc, 'fast_clk_ctrl', fast_clock_generator, 'power')
@@ -24,8 +24,15 @@
 #include <vp/itf/wire.hpp>
 #include <stdio.h>
 #include <string.h>
+#include <vector>
 #include "archi/eu_v3.h"
 
+// Broadcast push, in 2 32 bits accesses: the calling core first writes the target core
+// mask to its own mask register, then pushes the value with it. Contrary to the team
+// config, the mask is private to the calling core.
+#define EU_DISPATCH_PUSH_MASK               0x8
+#define EU_DISPATCH_FIFO_PUSH_MASK          0xC
+
 class Core_event_unit;
 class Event_unit;
 class Dispatch_unit;
@@ -73,15 +80,36 @@ private:
 
 };
 
+// Order in which a released mutex is handed over to the waiting cores
+typedef enum
+{
+  MUTEX_POLICY_PRIORITY,      // Lowest core index first
+  MUTEX_POLICY_FIFO,          // Arrival order
+  MUTEX_POLICY_ROUND_ROBIN    // Next waiting core after the current owner
+} Mutex_policy_e;
+
 class Mutex {
 public:
   void reset();
 
   //Plp3_ckg *top;
   bool locked;
+  int owner;
   uint32_t waiting_mask;
   uint32_t value;
   vp::IoReq *waiting_reqs[32];
+  int64_t wait_start[32];
+
+  // Waiting cores in arrival order, for the FIFO policy. The elected core can be anywhere
+  // in it with the other policies, so it is kept packed from index 0
+  int queue[32];
+  int queue_size;
+
+  // Statistics
+  int64_t stats_acquisitions;
+  int64_t stats_contended;
+  int64_t stats_wait_cycles;
+  int stats_max_waiters;
   //void sleepCancel(int coreId);
   //function<void (int)> sleepCancelCallback;
 };
@@ -96,13 +124,16 @@ public:
   //gv::trace trace;
   Mutex *mutexes;
   vp::IoReqStatus req(vp::IoReq *req, uint64_t offset, bool is_write, uint32_t *data, int core);
+  void stats_report();
 
 private:
   vp::IoReqStatus enqueue_sleep(Mutex *mutex, vp::IoReq *req, int core_id) ;
+  int elect_waiter(Mutex *mutex);
   Event_unit *top;
   vp::Trace     trace;
   int nb_mutexes;
   int mutex_event;
+  Mutex_policy_e policy;
 };
 
 
@@ -129,6 +160,21 @@ class Dispatch_core
 {
 public:
   int tail;
+  int depth;      // Maximum number of entries targeting this core which can be pending
+  int pending;    // Entries pushed for this core and not yet read
+  uint32_t push_mask;   // Target cores of the broadcast pushes done by this core
+};
+
+
+// Push which could not be done because one of the target cores has its FIFO full
+class Dispatch_push
+{
+public:
+  vp::IoReq *req;
+  uint32_t value;
+  uint32_t mask;
+  int core_id;
+  int64_t cycle;
 };
 
 
@@ -140,6 +186,7 @@ public:
   void reset();
 
   vp::IoReqStatus enqueue_sleep(Dispatch *dispatch, vp::IoReq *req, int core_id, bool is_caller=true);
+  void stats_report();
 
   //Plp3_ckg *top;
   //gv::trace trace;
@@ -151,11 +198,31 @@ public:
   //bool ioReq(gv::ioReq *req, uint32_t offset, bool isRead, uint32_t *data, int coreId);
   int dispatch_event;
 private:
+  vp::IoReqStatus push_req(vp::IoReq *req, uint32_t value, uint32_t mask, int core_id);
+  bool can_push(uint32_t mask);
+  void push(uint32_t value, uint32_t mask);
+  void pop(int core_id);
+  static void retry_handler(vp::Block *__this, vp::ClockEvent *event);
+
   Event_unit *top;
   Dispatch_core *core;
   Dispatch *dispatches;
   int size;
   int fifo_head;
+  bool flow_control;
+
+  // Pushes stalled on a full FIFO, retried in order each time an entry is read
+  std::vector<Dispatch_push> stalled_pushes;
+  vp::ClockEvent *retry_event;
+
+  // Statistics
+  int64_t stats_pushes;
+  int64_t stats_bcast_pushes;
+  int64_t stats_pops;
+  int64_t stats_empty_waits;
+  int64_t stats_stalls;
+  int64_t stats_stall_cycles;
+  int64_t stats_max_pending;
 };
 
 
@@ -177,12 +244,20 @@ public:
 
 private:
   void check_barrier(int barrier_id);
+  static void global_barrier_ack_sync(vp::Block *__this, bool value);
 
   Event_unit *top;
   vp::Trace     trace;
   Barrier *barriers;
   int nb_barriers;
   int barrier_event;
+
+  // Barrier extended to the other clusters, -1 if there is none. Once it is reached locally,
+  // it is forwarded to the global barrier and its event is only triggered when it is acknowledged.
+  int global_barrier_id;
+  bool global_barrier_pending;
+  vp::WireMaster<bool> global_barrier_req_itf;
+  vp::WireSlave<bool> global_barrier_ack_itf;
 };
 
 
@@ -194,6 +269,19 @@ typedef enum
   CORE_STATE_SKIP_ELW
 } Event_unit_core_state_e;
 
+// Causes of core wake-ups, used for statistics
+typedef enum
+{
+  EU_WAKEUP_BARRIER,
+  EU_WAKEUP_MUTEX,
+  EU_WAKEUP_DISPATCH,
+  EU_WAKEUP_EVENT,
+  EU_WAKEUP_IRQ,
+  EU_WAKEUP_NB_CAUSES
+} Event_unit_wakeup_cause_e;
+
+static const char *eu_wakeup_cause_names[] = { "barrier", "mutex", "dispatch", "event", "irq" };
+
 class Event_unit : public vp::Component
 {
 
@@ -208,6 +296,7 @@ public:
   Event_unit(vp::ComponentConf &config);
 
   void reset(bool active);
+  void stop();
 
   static vp::IoReqStatus req(vp::Block *__this, vp::IoReq *req);
   static vp::IoReqStatus demux_req(vp::Block *__this, vp::IoReq *req, int core);
@@ -216,6 +305,7 @@ public:
 protected:
 
   vp::Trace     trace;
+  vp::Trace     stats_trace;
 
   vp::IoSlave in;
 
@@ -226,11 +316,32 @@ protected:
   Soc_event_unit *soc_event_unit;
 
   int nb_core;
+  uint32_t all_cores_mask;
+
+  // Cluster-wide view of the core event states, with for each event line the mask of cores
+  // which have it pending in their status, and the mask of cores which have it enabled either
+  // as event or as IRQ. This allows computing the cores to be checked for all cores at once.
+  uint32_t event_pending[32];
+  uint32_t event_listen[32];
+
+  // Event numbers of the synchronization units, used to find the cause of a wake-up
+  int barrier_event;
+  int mutex_event;
+  int dispatch_event;
 
+  // Cluster idle state, notified to the rest of the cluster when all cores are clock-gated
+  // so that they can suspend any periodic work until a core is waken-up
+  int nb_gated_cores;
+  vp::reg_1 cluster_idle;
+  vp::WireMaster<bool> idle_itf;
+  int64_t idle_start;
+  int64_t stats_idle_periods;
+  int64_t stats_idle_cycles;
 
   vp::IoReqStatus sw_events_req(vp::IoReq *req, uint64_t offset, bool is_write, uint32_t *data);
   void trigger_event(int event, uint32_t core_mask);
   void send_event(int core, uint32_t mask);
+  void set_core_gated(int core, bool gated);
   static void in_event_sync(vp::Block *__this, bool active, int id);
 
 };
@@ -244,6 +355,7 @@ public:
   void build(Event_unit *top, int core_id);
   void set_status(uint32_t new_value);
   void clear_status(uint32_t mask);
+  void update_masks();
   void reset();
   void check_state();
   vp::IoReqStatus req(vp::IoReq *req, uint64_t offset, bool is_write, uint32_t *data);
@@ -257,6 +369,9 @@ public:
   void irq_ack_sync(int irq, int core);
   static void wakeup_handler(vp::Block *__this, vp::ClockEvent *event);
   static void irq_wakeup_handler(vp::Block *__this, vp::ClockEvent *event);
+  void stats_wakeup_request(Event_unit_wakeup_cause_e cause);
+  void stats_wakeup();
+  void stats_report();
 
   vp::IoSlave demux_in;
 
@@ -264,6 +379,7 @@ public:
   uint32_t evt_mask;
   uint32_t irq_mask;
   uint32_t clear_evt_mask;
+  uint32_t listen_mask;     // evt_mask | irq_mask, as last reported to the event unit
 
   int sync_irq;
   int pending_elw;
@@ -287,6 +403,13 @@ private:
 
   vp::reg_1  is_active;
 
+  // Statistics, the registers are cumulative and updated when the core is waken-up
+  vp::reg_32 sleep_cycles;
+  vp::reg_32 wakeups[EU_WAKEUP_NB_CAUSES];
+  vp::reg_32 wakeup_latency;
+  int64_t sleep_start;
+  int64_t wakeup_request_cycle;
+  Event_unit_wakeup_cause_e wakeup_cause;
 };
 
 
@@ -295,8 +418,17 @@ Event_unit::Event_unit(vp::ComponentConf &config)
 : vp::Component(config)
 {
   nb_core = get_js_config()->get_child_int("nb_core");
+  all_cores_mask = nb_core >= 32 ? -1 : (1U << nb_core) - 1;
 
   traces.new_trace("trace", &trace, vp::DEBUG);
+  traces.new_trace("stats", &stats_trace, vp::DEBUG);
+
+  barrier_event = get_js_config()->get_child_int("**/properties/events/barrier");
+  mutex_event = get_js_config()->get_child_int("**/properties/events/mutex");
+  dispatch_event = get_js_config()->get_child_int("**/properties/events/dispatch");
+
+  new_reg("cluster_idle", &cluster_idle, 0);
+  new_master_port("idle", &idle_itf);
 
   in.set_req_meth(&Event_unit::req);
   new_slave_port("input", &in);
@@ -318,6 +450,9 @@ void Event_unit::reset(bool active)
 {
   if (active)
   {
+    memset(event_pending, 0, sizeof(event_pending));
+    memset(event_listen, 0, sizeof(event_listen));
+
     for (int i=0; i<nb_core; i++)
     {
       core_eu[i].reset();
@@ -326,9 +461,65 @@ void Event_unit::reset(bool active)
     barrier_unit->reset();
     mutex->reset();
     soc_event_unit->reset();
+
+    nb_gated_cores = 0;
+    stats_idle_periods = 0;
+    stats_idle_cycles = 0;
   }
 }
 
+void Event_unit::set_core_gated(int core, bool gated)
+{
+  int64_t cycles = clock.get_cycles();
+
+  if (gated)
+  {
+    nb_gated_cores++;
+    if (nb_gated_cores == nb_core)
+    {
+      trace.msg("All cores are clock-gated, cluster is idle\n");
+      idle_start = cycles;
+      stats_idle_periods++;
+      cluster_idle.set(1);
+      if (idle_itf.is_bound())
+        idle_itf.sync(true);
+    }
+  }
+  else
+  {
+    if (nb_gated_cores == nb_core)
+    {
+      trace.msg("Core waken-up, cluster is active (core: %d)\n", core);
+      stats_idle_cycles += cycles - idle_start;
+      cluster_idle.set(0);
+      if (idle_itf.is_bound())
+        idle_itf.sync(false);
+    }
+    nb_gated_cores--;
+  }
+}
+
+void Event_unit::stop()
+{
+  int64_t idle_cycles = stats_idle_cycles;
+  if (nb_gated_cores == nb_core)
+    idle_cycles += clock.get_cycles() - idle_start;
+
+  stats_trace.msg(vp::Trace::LEVEL_INFO, "Core sleep statistics (total cycles: %ld, cluster idle: %ld cycles in %ld periods)\n",
+    clock.get_cycles(), idle_cycles, stats_idle_periods);
+  stats_trace.msg(vp::Trace::LEVEL_INFO, "%6s %12s %7s %8s %8s %8s %8s %8s %12s\n", "core", "sleep", "idle%",
+    eu_wakeup_cause_names[0], eu_wakeup_cause_names[1], eu_wakeup_cause_names[2],
+    eu_wakeup_cause_names[3], eu_wakeup_cause_names[4], "avg_latency");
+
+  for (int i=0; i<nb_core; i++)
+  {
+    core_eu[i].stats_report();
+  }
+
+  dispatch->stats_report();
+  mutex->stats_report();
+}
+
 vp::IoReqStatus Event_unit::req(vp::Block *__this, vp::IoReq *req)
 {
   Event_unit *_this = (Event_unit *)__this;
@@ -431,19 +622,43 @@ vp::IoReqStatus Event_unit::sw_events_req(vp::IoReq *req, uint64_t offset, bool
 
 void Event_unit::trigger_event(int event_mask, uint32_t core_mask)
 {
-  for (unsigned int i=0; i<nb_core; i++) {
-    if (core_mask == 0 || (core_mask & (1 << i))) {
-      send_event(i, event_mask);
-    }
+  uint32_t targets = core_mask ? core_mask & all_cores_mask : all_cores_mask;
+  uint32_t raised = 0;
+  uint32_t wakeup = 0;
+
+  trace.msg("Triggering event (coreMask: 0x%x, mask: 0x%x)\n", targets, event_mask);
+
+  // Only cores which did not already have one of the events pending see their status
+  // change, and only the ones listening to it need their state machine to be checked
+  uint32_t events = event_mask;
+  while (events)
+  {
+    int event = __builtin_ctz(events);
+    events &= events - 1;
+
+    uint32_t new_cores = targets & ~event_pending[event];
+    raised |= new_cores;
+    wakeup |= new_cores & event_listen[event];
+  }
+
+  while (raised)
+  {
+    int core = __builtin_ctz(raised);
+    raised &= raised - 1;
+    core_eu[core].set_status(core_eu[core].status | event_mask);
+  }
+
+  while (wakeup)
+  {
+    int core = __builtin_ctz(wakeup);
+    wakeup &= wakeup - 1;
+    core_eu[core].check_state();
   }
 }
 
 void Event_unit::send_event(int core, uint32_t mask)
 {
-  trace.msg("Triggering event (core: %d, mask: 0x%x)\n", core, mask);
-  Core_event_unit *eu = &core_eu[core];
-  eu->set_status(eu->status | mask);
-  eu->check_state();
+  trigger_event(mask, 1U << core);
 }
 
 
@@ -453,6 +668,12 @@ void Core_event_unit::build(Event_unit *top, int core_id)
   this->core_id = core_id;
 
   this->top->new_reg("core_" + std::to_string(core_id) + "/active", &this->is_active, 1);
+  this->top->new_reg("core_" + std::to_string(core_id) + "/sleep_cycles", &this->sleep_cycles, 0);
+  this->top->new_reg("core_" + std::to_string(core_id) + "/wakeup_latency", &this->wakeup_latency, 0);
+  for (int i=0; i<EU_WAKEUP_NB_CAUSES; i++)
+  {
+    this->top->new_reg("core_" + std::to_string(core_id) + "/wakeups/" + eu_wakeup_cause_names[i], &this->wakeups[i], 0);
+  }
 
   demux_in.set_req_meth_muxed(&Event_unit::demux_req, core_id);
   top->new_slave_port("demux_in_" + std::to_string(core_id), &demux_in);
@@ -502,6 +723,7 @@ vp::IoReqStatus Core_event_unit::req(vp::IoReq *req, uint64_t offset, bool is_wr
     if (!is_write) *data = evt_mask;
     else {
       evt_mask = *data;
+      update_masks();
       top->trace.msg("Updating event mask (newValue: 0x%x)\n", *data);
       check_state();
     }
@@ -510,6 +732,7 @@ vp::IoReqStatus Core_event_unit::req(vp::IoReq *req, uint64_t offset, bool is_wr
   {
     if (!is_write) return vp::IO_REQ_INVALID;
     evt_mask &= ~*data;
+    update_masks();
     top->trace.msg("Clearing event mask (mask: 0x%x, newValue: 0x%x)\n", *data, evt_mask);
     check_state();
   }
@@ -517,6 +740,7 @@ vp::IoReqStatus Core_event_unit::req(vp::IoReq *req, uint64_t offset, bool is_wr
   {
     if (!is_write) return vp::IO_REQ_INVALID;
     evt_mask |= *data;
+    update_masks();
     top->trace.msg("Setting event mask (mask: 0x%x, newValue: 0x%x)\n", *data, evt_mask);
     check_state();
   }
@@ -550,6 +774,7 @@ vp::IoReqStatus Core_event_unit::req(vp::IoReq *req, uint64_t offset, bool is_wr
     else {
       top->trace.msg("Updating irq mask (newValue: 0x%x)\n", *data);
       irq_mask = *data;
+      update_masks();
       check_state();
     }
   }
@@ -562,6 +787,7 @@ vp::IoReqStatus Core_event_unit::req(vp::IoReq *req, uint64_t offset, bool is_wr
   {
     if (!is_write) return vp::IO_REQ_INVALID;
     irq_mask &= ~*data;
+    update_masks();
     top->trace.msg("Clearing irq mask (mask: 0x%x, newValue: 0x%x)\n", *data, irq_mask);
     check_state();
   }
@@ -569,6 +795,7 @@ vp::IoReqStatus Core_event_unit::req(vp::IoReq *req, uint64_t offset, bool is_wr
   {
     if (!is_write) return vp::IO_REQ_INVALID;
     irq_mask |= *data;
+    update_masks();
     top->trace.msg("Setting irq mask (mask: 0x%x, newValue: 0x%x)\n", *data, irq_mask);
     check_state();
   }
@@ -651,9 +878,7 @@ void Event_unit::in_event_sync(vp::Block *__this, bool active, int id)
   int core_id = id >> 16;
   int event_id = id & 0xffff;
   _this->trace.msg("Received input event (core: %d, event: %d, active: %d)\n", core_id, event_id, active);
-  Core_event_unit *eu = &_this->core_eu[core_id];
-  eu->set_status(eu->status | (1<<event_id));
-  eu->check_state();
+  _this->send_event(core_id, 1<<event_id);
 }
 
 
@@ -677,15 +902,35 @@ void Core_event_unit::irq_ack_sync(int irq, int core)
 
 void Core_event_unit::set_status(uint32_t new_value)
 {
+  uint32_t changed = status ^ new_value;
+  while (changed)
+  {
+    int event = __builtin_ctz(changed);
+    changed &= changed - 1;
+    top->event_pending[event] ^= 1U << core_id;
+  }
   status = new_value;
 }
 
 void Core_event_unit::clear_status(uint32_t mask)
 {
-  status = status & ~mask;
+  set_status(status & ~mask);
   top->soc_event_unit->check_state();
 }
 
+void Core_event_unit::update_masks()
+{
+  uint32_t listen = evt_mask | irq_mask;
+  uint32_t changed = listen ^ listen_mask;
+  while (changed)
+  {
+    int event = __builtin_ctz(changed);
+    changed &= changed - 1;
+    top->event_listen[event] ^= 1U << core_id;
+  }
+  listen_mask = listen;
+}
+
 
 void Core_event_unit::check_pending_req()
 {
@@ -712,8 +957,11 @@ void Core_event_unit::check_wait_mask()
 vp::IoReqStatus Core_event_unit::put_to_sleep(vp::IoReq *req, Event_unit_core_state_e wait_state)
 {
   state = wait_state;
+  if (this->is_active.get())
+    top->set_core_gated(core_id, true);
   this->is_active.set(0);
   this->clock_itf.sync(0);
+  this->sleep_start = top->clock.get_cycles();
   pending_req = req;
   return vp::IO_REQ_PENDING;
 }
@@ -897,17 +1145,63 @@ void Core_event_unit::reset()
   status = 0;
   evt_mask = 0;
   irq_mask = 0;
+  listen_mask = 0;
   clear_evt_mask = 0;
   sync_irq = -1;
   pending_elw = false;
   state = CORE_STATE_NONE;
+  this->sleep_start = -1;
   this->clock_itf.sync(1);
 }
 
+void Core_event_unit::stats_wakeup_request(Event_unit_wakeup_cause_e cause)
+{
+  this->wakeup_cause = cause;
+  this->wakeup_request_cycle = top->clock.get_cycles();
+}
+
+void Core_event_unit::stats_wakeup()
+{
+  // Only account wake-ups of cores which were really clock-gated
+  if (this->sleep_start == -1)
+    return;
+
+  int64_t cycles = top->clock.get_cycles();
+  this->sleep_cycles.set(this->sleep_cycles.get() + cycles - this->sleep_start);
+  this->wakeup_latency.set(this->wakeup_latency.get() + cycles - this->wakeup_request_cycle);
+  this->wakeups[this->wakeup_cause].set(this->wakeups[this->wakeup_cause].get() + 1);
+  this->sleep_start = -1;
+}
+
+void Core_event_unit::stats_report()
+{
+  int64_t cycles = top->clock.get_cycles();
+  int64_t sleep = this->sleep_cycles.get();
+  int nb_wakeups = 0;
+
+  // Also count the current sleep period if the core is still gated
+  if (this->sleep_start != -1)
+    sleep += cycles - this->sleep_start;
+
+  for (int i=0; i<EU_WAKEUP_NB_CAUSES; i++)
+  {
+    nb_wakeups += this->wakeups[i].get();
+  }
+
+  top->stats_trace.msg(vp::Trace::LEVEL_INFO, "%6d %12ld %7.2f %8d %8d %8d %8d %8d %12.2f\n", core_id, sleep,
+    cycles ? 100.0 * sleep / cycles : 0.0, this->wakeups[EU_WAKEUP_BARRIER].get(),
+    this->wakeups[EU_WAKEUP_MUTEX].get(), this->wakeups[EU_WAKEUP_DISPATCH].get(),
+    this->wakeups[EU_WAKEUP_EVENT].get(), this->wakeups[EU_WAKEUP_IRQ].get(),
+    nb_wakeups ? (double)this->wakeup_latency.get() / nb_wakeups : 0.0);
+}
+
 void Core_event_unit::wakeup_handler(vp::Block *__this, vp::ClockEvent *event)
 {
   Core_event_unit *_this = (Core_event_unit *)__this;
   _this->top->trace.msg("Replying to core after wakeup (core: %d)\n", _this->core_id);
+  _this->stats_wakeup();
+  if (!_this->is_active.get())
+    _this->top->set_core_gated(_this->core_id, false);
   _this->is_active.set(1);
   _this->clock_itf.sync(1);
   _this->check_pending_req();
@@ -918,6 +1212,9 @@ void Core_event_unit::irq_wakeup_handler(vp::Block *__this, vp::ClockEvent *even
 {
   Core_event_unit *_this = (Core_event_unit *)__this;
   _this->top->trace.msg("IRQ wakeup\n");
+  _this->stats_wakeup();
+  if (!_this->is_active.get())
+    _this->top->set_core_gated(_this->core_id, false);
   _this->is_active.set(1);
   _this->clock_itf.sync(1);
   _this->check_state();
@@ -956,6 +1253,7 @@ void Core_event_unit::check_state()
 
       if (!irq_wakeup_event->is_enqueued())
       {
+        this->stats_wakeup_request(EU_WAKEUP_IRQ);
         top->event_enqueue(irq_wakeup_event, EU_WAKEUP_LATENCY);
         sync_irq = -1;
       }
@@ -980,6 +1278,15 @@ void Core_event_unit::check_state()
               check_wait_mask();
               if (!wakeup_event->is_enqueued())
               {
+                if (status_evt_masked & (1 << top->barrier_event))
+                  this->stats_wakeup_request(EU_WAKEUP_BARRIER);
+                else if (status_evt_masked & (1 << top->mutex_event))
+                  this->stats_wakeup_request(EU_WAKEUP_MUTEX);
+                else if (status_evt_masked & (1 << top->dispatch_event))
+                  this->stats_wakeup_request(EU_WAKEUP_DISPATCH);
+                else
+                  this->stats_wakeup_request(EU_WAKEUP_EVENT);
+
                 top->event_enqueue(wakeup_event, EU_WAKEUP_LATENCY);
               }
               break;
@@ -1004,6 +1311,19 @@ Mutex_unit::Mutex_unit(Event_unit *top)
   nb_mutexes = top->get_js_config()->get_child_int("**/properties/mutex/nb_mutexes");
   mutex_event = top->get_js_config()->get_child_int("**/properties/events/mutex");
   mutexes = new Mutex[nb_mutexes];
+
+  policy = MUTEX_POLICY_PRIORITY;
+  js::Config *policy_config = top->get_js_config()->get("**/properties/mutex/policy");
+  if (policy_config != NULL)
+  {
+    std::string name = policy_config->get_str();
+    if (name == "fifo")
+      policy = MUTEX_POLICY_FIFO;
+    else if (name == "round_robin")
+      policy = MUTEX_POLICY_ROUND_ROBIN;
+    else if (name != "priority")
+      top->trace.fatal("Unknown mutex policy: %s\n", name.c_str());
+  }
 }
 
 
@@ -1013,6 +1333,13 @@ vp::IoReqStatus Mutex_unit::enqueue_sleep(Mutex *mutex, vp::IoReq *req, int core
   // Enqueue the request so that the core can be unstalled when a value is pushed
   mutex->waiting_reqs[core_id] = req;
   mutex->waiting_mask |= 1<<core_id;
+  mutex->wait_start[core_id] = top->clock.get_cycles();
+  mutex->queue[mutex->queue_size] = core_id;
+  mutex->queue_size++;
+
+  int nb_waiters = __builtin_popcount(mutex->waiting_mask);
+  if (nb_waiters > mutex->stats_max_waiters)
+    mutex->stats_max_waiters = nb_waiters;
 
   // Don't forget to remember to clear the event after wake-up by the dispatch event
   core_eu->clear_evt_mask = 1<<mutex_event;
@@ -1021,6 +1348,43 @@ vp::IoReqStatus Mutex_unit::enqueue_sleep(Mutex *mutex, vp::IoReq *req, int core
 }
 
 
+int Mutex_unit::elect_waiter(Mutex *mutex)
+{
+  switch (policy)
+  {
+    case MUTEX_POLICY_FIFO:
+      return mutex->queue[0];
+
+    case MUTEX_POLICY_ROUND_ROBIN:
+    {
+      // Rotate the mask so that the core following the owner comes first
+      int shift = (mutex->owner + 1) % 32;
+      uint32_t rotated = shift ? (mutex->waiting_mask >> shift) | (mutex->waiting_mask << (32 - shift)) : mutex->waiting_mask;
+      return (__builtin_ctz(rotated) + shift) % 32;
+    }
+
+    default:
+      return __builtin_ctz(mutex->waiting_mask);
+  }
+}
+
+
+void Mutex_unit::stats_report()
+{
+  top->stats_trace.msg(vp::Trace::LEVEL_INFO, "%6s %12s %12s %12s %12s %12s\n", "mutex", "acquisitions", "contended",
+    "wait_cycles", "avg_wait", "max_waiters");
+
+  for (int i=0; i<nb_mutexes; i++)
+  {
+    Mutex *mutex = &mutexes[i];
+    top->stats_trace.msg(vp::Trace::LEVEL_INFO, "%6d %12ld %12ld %12ld %12.2f %12d\n", i, mutex->stats_acquisitions,
+      mutex->stats_contended, mutex->stats_wait_cycles,
+      mutex->stats_contended ? (double)mutex->stats_wait_cycles / mutex->stats_contended : 0.0,
+      mutex->stats_max_waiters);
+  }
+}
+
+
 void Mutex_unit::reset()
 {
   for (int i=0; i<nb_mutexes; i++)
@@ -1032,7 +1396,13 @@ void Mutex_unit::reset()
 void Mutex::reset()
 {
   locked = false;
+  owner = -1;
   waiting_mask = 0;
+  queue_size = 0;
+  stats_acquisitions = 0;
+  stats_contended = 0;
+  stats_wait_cycles = 0;
+  stats_max_waiters = 0;
 }
 
 
@@ -1065,6 +1435,8 @@ vp::IoReqStatus Mutex_unit::req(vp::IoReq *req, uint64_t offset, bool is_write,
       // The mutex is free, just lock it
       top->trace.msg("Locking mutex (mutex: %d, coreId: %d)\n", id, core);
       mutex->locked = 1;
+      mutex->owner = core;
+      mutex->stats_acquisitions++;
     }
     else
     {
@@ -1081,30 +1453,43 @@ vp::IoReqStatus Mutex_unit::req(vp::IoReq *req, uint64_t offset, bool is_write,
     unsigned int waiting_mask = mutex->waiting_mask;
     if (waiting_mask)
     {
-      // We have to wake-up one core, take the first one
-      for (unsigned int i=0; i<32; i++)
-      {
-        if (waiting_mask & (1<<i))
-        {
-          top->trace.msg("Transfering mutex lock (mutex: %d, fromCore: %d, toCore: %d)\n", id, core, i);
-          // Clear the mask and wake-up the elected core. Don't unlock the mutex, as it is
-          // taken by the new core
-          top->trace.msg("Waking-up core waiting for dispatch value (coreId: %d)\n", i);
-          vp::IoReq *waiting_req = mutex->waiting_reqs[i];
+      // We have to wake-up one core, elected according to the handoff policy
+      int i = elect_waiter(mutex);
 
-          mutex->waiting_mask &= ~(1<<i);
+      top->trace.msg("Transfering mutex lock (mutex: %d, fromCore: %d, toCore: %d)\n", id, core, i);
+      // Clear the mask and wake-up the elected core. Don't unlock the mutex, as it is
+      // taken by the new core
+      top->trace.msg("Waking-up core waiting for dispatch value (coreId: %d)\n", i);
+      vp::IoReq *waiting_req = mutex->waiting_reqs[i];
 
-          // Store the mutex value into the pending request
-          // Don't reply now to the initiator, this will be done by the wakeup event
-          // to introduce some delays
-          *(uint32_t *)waiting_req->get_data() = mutex->value;
-
-          // And trigger the event to the core
-          top->trigger_event(1<<mutex_event, 1<<i); 
+      mutex->waiting_mask &= ~(1<<i);
 
+      // Remove the core from the arrival queue
+      for (int j=0; j<mutex->queue_size; j++)
+      {
+        if (mutex->queue[j] == i)
+        {
+          for (int k=j; k<mutex->queue_size-1; k++)
+          {
+            mutex->queue[k] = mutex->queue[k + 1];
+          }
+          mutex->queue_size--;
           break;
         }
       }
+
+      mutex->owner = i;
+      mutex->stats_acquisitions++;
+      mutex->stats_contended++;
+      mutex->stats_wait_cycles += top->clock.get_cycles() - mutex->wait_start[i];
+
+      // Store the mutex value into the pending request
+      // Don't reply now to the initiator, this will be done by the wakeup event
+      // to introduce some delays
+      *(uint32_t *)waiting_req->get_data() = mutex->value;
+
+      // And trigger the event to the core
+      top->trigger_event(1<<mutex_event, 1<<i); 
     } 
     else
     {
@@ -1149,6 +1534,33 @@ Dispatch_unit::Dispatch_unit(Event_unit *top)
   size = top->get_js_config()->get_child_int("**/properties/dispatch/size");
   core = new Dispatch_core[top->nb_core];
   dispatches = new Dispatch[size];
+  retry_event = top->event_new((vp::Block *)this, Dispatch_unit::retry_handler);
+
+  // The per-core depth can be given either for all cores or as a list with one depth per core.
+  // Pushes are only flow-controlled when it is specified, otherwise the oldest entry is
+  // overwritten as before.
+  js::Config *depth_config = top->get_js_config()->get("**/properties/dispatch/core_depth");
+  flow_control = depth_config != NULL;
+  int nb_depths = depth_config != NULL ? depth_config->get_elems().size() : 0;
+  if (nb_depths != 0 && nb_depths != top->nb_core)
+  {
+    top->trace.fatal("Dispatch core_depth list must have one entry per core (entries: %d, cores: %d)\n",
+      nb_depths, top->nb_core);
+    return;
+  }
+
+  for (int i=0; i<top->nb_core; i++)
+  {
+    int depth = size;
+    if (depth_config != NULL)
+    {
+      if (nb_depths)
+        depth = depth_config->get_elems()[i]->get_int();
+      else
+        depth = depth_config->get_int();
+    }
+    core[i].depth = depth < size ? depth : size;
+  }
 }
 
   void Dispatch_unit::reset()
@@ -1158,6 +1570,8 @@ Dispatch_unit::Dispatch_unit(Event_unit *top)
     for (int i=0; i<top->nb_core; i++)
     {
       core[i].tail = 0;
+      core[i].pending = 0;
+      core[i].push_mask = 0;
     }
     for (int i=0; i<size; i++)
     {
@@ -1166,80 +1580,177 @@ Dispatch_unit::Dispatch_unit(Event_unit *top)
       dispatches[i].config_mask = 0;
       dispatches[i].waiting_mask = 0;
     }
+    stalled_pushes.clear();
+    stats_pushes = 0;
+    stats_bcast_pushes = 0;
+    stats_pops = 0;
+    stats_empty_waits = 0;
+    stats_stalls = 0;
+    stats_stall_cycles = 0;
+    stats_max_pending = 0;
   }
 
-  vp::IoReqStatus Dispatch_unit::req(vp::IoReq *req, uint64_t offset, bool is_write, uint32_t *data, int core_id)
+  bool Dispatch_unit::can_push(uint32_t mask)
   {
-    if (offset == EU_DISPATCH_FIFO_ACCESS)
+    if (!flow_control)
+      return true;
+
+    // The entry which is going to be overwritten must have been read by all the cores it was targeting
+    Dispatch *dispatch = &dispatches[fifo_head];
+    if (dispatch->status_mask & dispatch->config_mask)
+      return false;
+
+    // And each targeted core must have room in its own FIFO
+    for (int i=0; i<top->nb_core; i++)
     {
-      if (is_write)
+      if ((mask & (1<<i)) && core[i].pending >= core[i].depth)
+        return false;
+    }
+
+    return true;
+  }
+
+  void Dispatch_unit::pop(int core_id)
+  {
+    stats_pops++;
+    if (flow_control)
+      core[core_id].pending--;
+
+    if (stalled_pushes.size() && !retry_event->is_enqueued())
+      top->event_enqueue(retry_event, 1);
+  }
+
+  void Dispatch_unit::push(uint32_t value, uint32_t mask)
+  {
+    unsigned int id = fifo_head++;
+    if (fifo_head == size) fifo_head = 0;
+
+    Dispatch *dispatch = &dispatches[id];
+
+    stats_pushes++;
+
+    // Occupancy is only meaningful when entries cannot be overwritten
+    for (int i=0; flow_control && i<top->nb_core; i++)
+    {
+      if (mask & (1<<i))
       {
-        unsigned int id = fifo_head++;
-        if (fifo_head == size) fifo_head = 0;
+        core[i].pending++;
+        if (core[i].pending > stats_max_pending)
+          stats_max_pending = core[i].pending;
+      }
+    }
 
-        Dispatch *dispatch = &dispatches[id];
+    // When pushing to the FIFO, the global config is pushed to the elected dispatcher
+    dispatch->config_mask = mask;     // Cores that will get a valid value
 
-        // When pushing to the FIFO, the global config is pushed to the elected dispatcher
-        dispatch->config_mask = config;     // Cores that will get a valid value
+    top->trace.msg("Pushing dispatch value (dispatch: %d, value: 0x%x, coreMask: 0x%x)\n", id, value, dispatch->config_mask);
+
+    // Case where the master push a value
+    dispatch->value = value;
+    // Reinitialize the status mask to notify a new value is ready
+    dispatch->status_mask = -1;
+    // Then wake-up the waiting cores
+    unsigned int wait_mask = dispatch->waiting_mask & dispatch->status_mask;
+    for (int i=0; i<32 && wait_mask; i++)
+    {
+      if (wait_mask & (1<<i))
+      {
+        // Only wake-up the core if he's actually involved in the team
+        if (dispatch->config_mask & (1<<i))
+        {
+          top->trace.msg("Waking-up core waiting for dispatch value (coreId: %d)\n", i);
+          vp::IoReq *waiting_req = dispatch->waiting_reqs[i];
 
-        top->trace.msg("Pushing dispatch value (dispatch: %d, value: 0x%x, coreMask: 0x%x)\n", id, *data, dispatch->config_mask);
+          // Clear the status bit as the waking core takes the data
+          dispatch->status_mask &= ~(1<<i);
+          dispatch->waiting_mask &= ~(1<<i);
 
-        // Case where the master push a value
-        dispatch->value = *data;
-        // Reinitialize the status mask to notify a new value is ready
-        dispatch->status_mask = -1;
-        // Then wake-up the waiting cores
-        unsigned int mask = dispatch->waiting_mask & dispatch->status_mask;
-        for (int i=0; i<32 && mask; i++)
+          // Store the dispatch value into the pending request
+          // Don't reply now to the initiator, this will be done by the wakeup event
+          // to introduce some delays
+          *(uint32_t *)waiting_req->get_data() = dispatch->value;
+
+          // Update the core fifo
+          core[i].tail++;
+          if (core[i].tail == size) core[i].tail = 0;
+          pop(i);
+
+          // Clear the mask to stop iterating early
+          wait_mask &= ~(1<<i);
+
+          // And trigger the event to the core
+          top->trigger_event(1<<dispatch_event, 1<<i); 
+        }
+        // Otherwise keep him sleeping and increase its index so that he will bypass this entry when he wakes up
+        else
         {
-          if (mask & (1<<i))
-          {
-            // Only wake-up the core if he's actually involved in the team
-            if (dispatch->config_mask & (1<<i))
-            {
-              top->trace.msg("Waking-up core waiting for dispatch value (coreId: %d)\n", i);
-              vp::IoReq *waiting_req = dispatch->waiting_reqs[i];
-
-              // Clear the status bit as the waking core takes the data
-              dispatch->status_mask &= ~(1<<i);
-              dispatch->waiting_mask &= ~(1<<i);
-
-              // Store the dispatch value into the pending request
-              // Don't reply now to the initiator, this will be done by the wakeup event
-              // to introduce some delays
-              *(uint32_t *)waiting_req->get_data() = dispatch->value;
-
-              // Update the core fifo
-              core[i].tail++;
-              if (core[i].tail == size) core[i].tail = 0;
-
-              // Clear the mask to stop iterating early
-              mask &= ~(1<<i);
-
-              // And trigger the event to the core
-              top->trigger_event(1<<dispatch_event, 1<<i); 
-            }
-            // Otherwise keep him sleeping and increase its index so that he will bypass this entry when he wakes up
-            else
-            {
-              // Cancel current dispatch sleep
-              dispatch->status_mask &= ~(1<<i);
-              dispatch->waiting_mask &= ~(1<<i);
-              vp::IoReq *pending_req = dispatch->waiting_reqs[i];
-
-              // Bypass the current entry
-              core[i].tail++;
-              if (core[i].tail == size) core[i].tail = 0;
-
-              // And reenqueue to the next entry
-              id = core[i].tail;
-              enqueue_sleep(&dispatches[id], pending_req, i, false);
-              top->trace.msg("Incrementing core counter to bypass entry (coreId: %d, newIndex: %d)\n", i, id);
-            }
-          }
+          // Cancel current dispatch sleep
+          dispatch->status_mask &= ~(1<<i);
+          dispatch->waiting_mask &= ~(1<<i);
+          vp::IoReq *pending_req = dispatch->waiting_reqs[i];
+
+          // Bypass the current entry
+          core[i].tail++;
+          if (core[i].tail == size) core[i].tail = 0;
+
+          // And reenqueue to the next entry
+          id = core[i].tail;
+          enqueue_sleep(&dispatches[id], pending_req, i, false);
+          top->trace.msg("Incrementing core counter to bypass entry (coreId: %d, newIndex: %d)\n", i, id);
         }
+      }
+    }
+  }
 
-        return vp::IO_REQ_OK;        
+  vp::IoReqStatus Dispatch_unit::push_req(vp::IoReq *req, uint32_t value, uint32_t mask, int core_id)
+  {
+    // Pushes are kept in order, so a push must also wait if older ones are already stalled
+    if (stalled_pushes.size() || !can_push(mask))
+    {
+      top->trace.msg("Dispatch FIFO full, stalling push (coreId: %d, value: 0x%x, coreMask: 0x%x)\n", core_id, value, mask);
+      stats_stalls++;
+      stalled_pushes.push_back({ req, value, mask, core_id, top->clock.get_cycles() });
+      return vp::IO_REQ_PENDING;
+    }
+
+    push(value, mask);
+
+    return vp::IO_REQ_OK;
+  }
+
+  void Dispatch_unit::retry_handler(vp::Block *__this, vp::ClockEvent *event)
+  {
+    Dispatch_unit *_this = (Dispatch_unit *)__this;
+
+    while (_this->stalled_pushes.size() && _this->can_push(_this->stalled_pushes.front().mask))
+    {
+      Dispatch_push stalled = _this->stalled_pushes.front();
+      _this->stalled_pushes.erase(_this->stalled_pushes.begin());
+
+      _this->top->trace.msg("Resuming stalled push (coreId: %d)\n", stalled.core_id);
+      _this->stats_stall_cycles += _this->top->clock.get_cycles() - stalled.cycle;
+
+      _this->push(stalled.value, stalled.mask);
+      stalled.req->get_resp_port()->resp(stalled.req);
+    }
+  }
+
+  void Dispatch_unit::stats_report()
+  {
+    top->stats_trace.msg(vp::Trace::LEVEL_INFO, "Dispatch statistics (pushes: %ld, broadcast pushes: %ld, pops: %ld, "
+      "empty waits: %ld, stalls: %ld, stall cycles: %ld)\n", stats_pushes, stats_bcast_pushes,
+      stats_pops, stats_empty_waits, stats_stalls, stats_stall_cycles);
+    if (flow_control)
+      top->stats_trace.msg(vp::Trace::LEVEL_INFO, "Dispatch occupancy (max pending: %ld)\n", stats_max_pending);
+  }
+
+  vp::IoReqStatus Dispatch_unit::req(vp::IoReq *req, uint64_t offset, bool is_write, uint32_t *data, int core_id)
+  {
+    if (offset == EU_DISPATCH_FIFO_ACCESS)
+    {
+      if (is_write)
+      {
+        return push_req(req, *data, config, core_id);
       }
       else
       {
@@ -1269,11 +1780,13 @@ Dispatch_unit::Dispatch_unit(Event_unit *top)
           top->trace.msg("Getting ready dispatch value (dispatch: %d, value: %x, dispatchStatus: 0x%x)\n", id, dispatch->value, dispatch->status_mask);
           core[core_id].tail++;
           if (core[core_id].tail == size) core[core_id].tail = 0;
+          pop(core_id);
         }
         else
         {
           // Nothing is ready, go to sleep
           top->trace.msg("No ready dispatch value, going to sleep (dispatch: %d, value: %x, dispatchStatus: 0x%x)\n", id, dispatch->value, dispatch->status_mask);
+          stats_empty_waits++;
           return enqueue_sleep(dispatch, req, core_id);
         }
 
@@ -1282,6 +1795,22 @@ Dispatch_unit::Dispatch_unit(Event_unit *top)
 
       return vp::IO_REQ_INVALID;
     }
+    else if (offset == EU_DISPATCH_PUSH_MASK)
+    {
+      if (is_write)
+        core[core_id].push_mask = *data;
+      else
+        *data = core[core_id].push_mask;
+      return vp::IO_REQ_OK;
+    }
+    else if (offset == EU_DISPATCH_FIFO_PUSH_MASK)
+    {
+      if (!is_write)
+        return vp::IO_REQ_INVALID;
+
+      stats_bcast_pushes++;
+      return push_req(req, *data, core[core_id].push_mask, core_id);
+    }
     else if (offset == EU_DISPATCH_TEAM_CONFIG)
     {
       config = *data;
@@ -1310,6 +1839,18 @@ Barrier_unit::Barrier_unit(Event_unit *top)
   nb_barriers = top->get_js_config()->get_child_int("**/properties/barriers/nb_barriers");
   barrier_event = top->get_js_config()->get_child_int("**/properties/events/barrier");
   barriers = new Barrier[nb_barriers];
+
+  js::Config *global_config = top->get_js_config()->get("**/properties/barriers/global_barrier");
+  global_barrier_id = global_config ? global_config->get_int() : -1;
+  if (global_barrier_id >= nb_barriers)
+  {
+    top->trace.fatal("Invalid global barrier (barrier: %d, nb_barriers: %d)\n", global_barrier_id, nb_barriers);
+    return;
+  }
+
+  top->new_master_port("global_barrier_req", &global_barrier_req_itf);
+  global_barrier_ack_itf.set_sync_meth(&Barrier_unit::global_barrier_ack_sync);
+  top->new_slave_port("global_barrier_ack", &global_barrier_ack_itf, (vp::Block *)this);
 }
 
 void Barrier_unit::check_barrier(int barrier_id)
@@ -1321,10 +1862,32 @@ void Barrier_unit::check_barrier(int barrier_id)
     trace.msg("Barrier reached, triggering event (barrier: %d, coreMask: 0x%x, targetMask: 0x%x)\n", barrier_id, barrier->core_mask, barrier->target_mask);
     barrier->status = 0;
 
+    if ((int)barrier_id == global_barrier_id && global_barrier_req_itf.is_bound())
+    {
+      trace.msg("Forwarding barrier to global barrier (barrier: %d)\n", barrier_id);
+      global_barrier_pending = true;
+      global_barrier_req_itf.sync(true);
+      return;
+    }
+
     top->trigger_event(1<<barrier_event, barrier->target_mask);
   }
 }
 
+void Barrier_unit::global_barrier_ack_sync(vp::Block *__this, bool value)
+{
+  Barrier_unit *_this = (Barrier_unit *)__this;
+
+  if (value && _this->global_barrier_pending)
+  {
+    Barrier *barrier = &_this->barriers[_this->global_barrier_id];
+    _this->trace.msg("Global barrier reached, triggering event (barrier: %d, targetMask: 0x%x)\n",
+      _this->global_barrier_id, barrier->target_mask);
+    _this->global_barrier_pending = false;
+    _this->top->trigger_event(1<<_this->barrier_event, barrier->target_mask);
+  }
+}
+
 
 vp::IoReqStatus Barrier_unit::req(vp::IoReq *req, uint64_t offset, bool is_write, uint32_t *data, int core)
 {
@@ -1447,6 +2010,7 @@ void Barrier_unit::reset()
     barrier->status = 0;
     barrier->target_mask = 0;
   }
+  global_barrier_pending = false;
 }
 
 
@@ -19,7 +19,8 @@ import gvsoc.systree as st
 class Mchan(st.Component):
 
     def __init__(self, parent, name, nb_channels=0, core_queue_depth=2, global_queue_depth=8, is_64=False, max_nb_ext_read_req=8,
-            max_nb_ext_write_req=8, max_burst_length=256, nb_loc_ports=4, tcdm_addr_width=20, power_models_file=None):
+            max_nb_ext_write_req=8, max_burst_length=256, nb_loc_ports=4, tcdm_addr_width=20, power_models_file=None,
+            loc_port_width=4, fast_mode=False):
         super(Mchan, self).__init__(parent, name)
 
         self.vcd_group(self, skip=True)
@@ -35,7 +36,9 @@ class Mchan(st.Component):
             'max_nb_ext_write_req': max_nb_ext_write_req,
             'max_burst_length': max_burst_length,
             'nb_loc_ports': nb_loc_ports,
+            'loc_port_width': loc_port_width,
             'tcdm_addr_width': tcdm_addr_width,
+            'fast_mode': fast_mode,
         })
 
         if power_models_file is not None:
@@ -54,3 +57,7 @@ class Mchan(st.Component):
                 dma_signals.append(['channel_%d' % i, 'channel_%d' % i, '[7:0]'])
 
             tree.add_vector(self, self.name, traces=dma_signals, map_file=map_file, tag='overview')
+
+            tree.add_trace(self, 'ext_stalled', 'ext_stalled', '[0:0]', tag='overview')
+            tree.add_trace(self, 'read_queue', 'read_queue', '[7:0]', tag='overview')
+            tree.add_trace(self, 'write_queue', 'write_queue', '[7:0]', tag='overview')
@@ -25,16 +25,33 @@
 #include <stdio.h>
 #include <string.h>
 #include <vector>
+#include <algorithm>
+#include <stdexcept>
 
 using namespace std;
 
 #include "archi/mchan_v7.h"
 
-// The number of writes to an input port queue register, that triggers an enqueue
-#define MAX_CMD_WORDS 5
+// The maximum number of writes to an input port queue register for one command
+#define MAX_CMD_WORDS 8
+
+// Command word extensions which are not yet in the generated archi header.
+// 3D transfers add a plane length and a plane stride after the 2D words.
+// Linked commands are followed by the L1 address of a descriptor chain.
+#define MCHAN_CMD_CMD__3D_EXT_GET(value)    (ARCHI_BEXTRACTU((value),1,24))
+#define MCHAN_CMD_CMD_LINKED_GET(value)     (ARCHI_BEXTRACTU((value),1,25))
+
+// Descriptors are 8 words in L1: command, TCDM address, EXT address, 2D length, 2D stride,
+// 3D length, 3D stride and address of the next descriptor (0 ends the chain)
+#define MCHAN_DESC_NB_WORDS 8
+#define MCHAN_DESC_NEXT     7
 
 #define MCHAN_NB_COUNTERS 16
 
+// Number of bins of the command latency histogram, bin i counts latencies in [2^i, 2^(i+1)[,
+// the last one also counts everything above
+#define MCHAN_LATENCY_BINS 16
+
 class mchan;
 class Mchan_channel;
 
@@ -43,6 +60,9 @@ class Mchan_cmd {
 public:
   Mchan_cmd(mchan *top) {}
   void init();
+  void unpack_header(uint32_t value);
+  void start_3d(uint32_t length, uint32_t stride);
+  void next_burst(uint64_t &ext, uint64_t &ext_chunk, uint64_t &loc, int size);
 
   // As the node is written through a sequence in the same register, this gives the step in the sequence
   // (from 0 to MAX_CMD_WORDS - 1). This triggers an enqueue when it reaches MAX_CMD_WORDS
@@ -66,10 +86,18 @@ public:
   uint32_t stride;
   uint32_t length;
   uint32_t remLength;
+  int is_3d;
+  uint32_t plane_length;       // Bytes per plane for 3D transfers, multiple of length
+  uint32_t plane_stride;
+  uint32_t plane_size_to_read;
+  uint64_t plane_chunk;
+  int is_linked;
+  uint32_t desc_addr;          // L1 address of the next descriptor of a linked command
   int loc2ext;         // 1 if transfer is from local port to external port
   int size;            // Size in bytes
   int size_left;
   int counter_id;       // Counter id for transfer termination
+  int64_t push_cycle;   // Cycle where the command was pushed to the core queue
   int raise_irq;        // If not 0, raise an interrupt at end of transfer
   int raise_event;
   int broadcast;
@@ -103,6 +131,7 @@ public:
   bool is_full() { return nb_cmd >= size; }
   bool is_empty() { return nb_cmd == 0; }
   T *get_first() { return first; }
+  int get_nb_cmd() { return nb_cmd; }
 
 private:
   T *first;    // First command of the queue, commands are popped from here
@@ -124,10 +153,30 @@ public:
 protected:
 
   Mchan_cmd *pop_cmd(bool read_queue);
+  void release_cmd_slot();
   void trigger_event(Mchan_cmd *cmd);
+  void stats_queue_update();
+  void stats_account_bytes(int bytes);
+  void stats_account_cmd(int64_t latency);
+  void stats_report();
 
   int current_counter;
 
+  // Statistics
+  int64_t stats_bytes;
+  int64_t stats_nb_cmd;
+  int64_t stats_latency_sum;
+  int64_t stats_latency_max;
+  int64_t stats_latency_hist[MCHAN_LATENCY_BINS];
+  int stats_queue_max;
+  int64_t stats_queue_stalls;
+  int64_t stats_queue_stall_cycles;
+  int64_t stats_queue_stall_start;
+  int64_t stats_alloc_stalls;
+  int64_t stats_alloc_stall_cycles;
+  int64_t stats_alloc_stall_start;
+  int64_t stats_desc;
+
 private:
 
   vp::IoReqStatus handle_queue_req(vp::IoReq *req, bool is_write, uint32_t *value);
@@ -148,6 +197,8 @@ private:
   vp::WireMaster<bool> event_itf;
   vp::WireMaster<bool> irq_itf;
 
+  vp::Trace bytes_event;
+  vp::Trace queue_event;
 };
 
 class mchan : public vp::Component
@@ -160,6 +211,7 @@ public:
   mchan(vp::ComponentConf &config);
 
   void reset(bool active);
+  void stop();
 
 protected:
   static vp::IoReqStatus req(vp::Block *__this, vp::IoReq *req, int id);
@@ -172,8 +224,10 @@ protected:
   void check_queue();
 
   int pending_bytes[MCHAN_NB_COUNTERS];
+  int pending_chains[MCHAN_NB_COUNTERS];
   int nb_core_read_cmd;
   int nb_core_write_cmd;
+  vp::Trace stats_trace;
 
 private:
 
@@ -181,6 +235,8 @@ private:
   static void check_ext_read_handler(vp::Block *_this, vp::ClockEvent *event);
   static void check_ext_write_handler(vp::Block *_this, vp::ClockEvent *event);
   static void check_loc_transfer_handler(vp::Block *_this, vp::ClockEvent *event);
+  static void fast_end_handler(vp::Block *_this, vp::ClockEvent *event);
+  static void desc_fetch_handler(vp::Block *_this, vp::ClockEvent *event);
   void move_to_global_queue(bool read_queue);
   void push_req_to_loc(vp::IoReq *req);
   void send_req();
@@ -193,6 +249,18 @@ private:
   void account_transfered_bytes(Mchan_cmd *cmd, int bytes);
   void send_req_to_ext(Mchan_cmd *cmd, vp::IoReq *req);
   void handle_ext_write_req_end(Mchan_cmd *cmd, vp::IoReq *req);
+  int64_t send_loc_beat(int port, uint32_t addr, uint8_t *data, int32_t size, bool is_write);
+  int64_t fast_loc_burst(vp::IoReq *ext_req, bool is_write);
+  void fast_ext2loc(Mchan_cmd *cmd);
+  void fast_loc2ext(Mchan_cmd *cmd);
+  void fast_cmd_end(Mchan_cmd *cmd, int done_size, int64_t latency);
+  void stats_queue_update();
+  void stats_ext_stall(bool stalled);
+  void push_chain(Mchan_cmd *chain);
+  void fetch_desc(Mchan_cmd *chain);
+  void end_chain(Mchan_cmd *chain);
+  void raise_counter_event(Mchan_cmd *cmd);
+  void push_desc_cmd();
 
   vp::Trace     trace;
 
@@ -204,7 +272,9 @@ private:
   int max_nb_ext_write_req;
   int max_burst_length;
   int nb_loc_ports;
+  int loc_port_width;     // Bytes moved by a local port per access, 4 is the accurate word model
   int tcdm_addr_width;
+  bool fast_mode;         // Uncontended commands are copied at once and terminated at an estimated cycle
 
   int nb_pending_ext_read_req;
   int nb_pending_ext_write_req;
@@ -216,6 +286,8 @@ private:
   vp::ClockEvent *check_ext_read_event;
   vp::ClockEvent *check_ext_write_event;
   vp::ClockEvent *check_loc_transfer_event;
+  vp::ClockEvent *fast_end_event;
+  vp::ClockEvent *desc_fetch_event;
   int sched_core_queue;
   Mchan_queue<Mchan_cmd> *pending_read_cmds;
   Mchan_queue<Mchan_cmd> *pending_write_cmds;
@@ -227,6 +299,10 @@ private:
   vp::IoReq *first_ext_write_req = NULL;
   vp::IoReq *loc_req;
   vp::IoReq *pending_loc_read_req;
+  Mchan_cmd *fast_cmd;    // Command copied by the fast mode and waiting for its termination cycle
+  Mchan_queue<Mchan_cmd> *pending_chain_cmds;
+  Mchan_cmd *current_chain_cmd;
+  Mchan_cmd *desc_cmd;    // Command built from the last fetched descriptor, waiting for a global queue slot
 
   Mchan_cmd *first_command = NULL;
 
@@ -239,6 +315,17 @@ private:
 
   vp::Trace     cmd_events[MCHAN_NB_COUNTERS];
   vp::WireMaster<bool> ext_irq_itf;
+
+  // Statistics
+  int64_t stats_start_cycle;
+  int64_t stats_ext_stalls;
+  int64_t stats_ext_stall_cycles;
+  int64_t stats_ext_stall_start;
+  int stats_read_queue_max;
+  int stats_write_queue_max;
+  vp::Trace ext_stalled_event;
+  vp::Trace read_queue_event;
+  vp::Trace write_queue_event;
 };
 
 void Mchan_channel::reset()
@@ -247,6 +334,73 @@ void Mchan_channel::reset()
   pending_cmd = 0;
   current_cmd = NULL;
   pending_cmds->init();
+
+  stats_bytes = 0;
+  stats_nb_cmd = 0;
+  stats_latency_sum = 0;
+  stats_latency_max = 0;
+  for (int i=0; i<MCHAN_LATENCY_BINS; i++)
+  {
+    stats_latency_hist[i] = 0;
+  }
+  stats_queue_max = 0;
+  stats_queue_stalls = 0;
+  stats_queue_stall_cycles = 0;
+  stats_alloc_stalls = 0;
+  stats_alloc_stall_cycles = 0;
+  stats_desc = 0;
+}
+
+void Mchan_channel::stats_queue_update()
+{
+  uint8_t value = pending_cmd;
+  queue_event.event(&value);
+  if (pending_cmd > stats_queue_max)
+    stats_queue_max = pending_cmd;
+}
+
+void Mchan_channel::stats_account_bytes(int bytes)
+{
+  stats_bytes += bytes;
+  uint32_t value = stats_bytes;
+  bytes_event.event((uint8_t *)&value);
+}
+
+void Mchan_channel::stats_account_cmd(int64_t latency)
+{
+  int bin = 0;
+  while (bin < MCHAN_LATENCY_BINS - 1 && (latency >> (bin + 1)) != 0)
+    bin++;
+
+  stats_nb_cmd++;
+  stats_latency_sum += latency;
+  stats_latency_hist[bin]++;
+  if (latency > stats_latency_max)
+    stats_latency_max = latency;
+}
+
+void Mchan_channel::stats_report()
+{
+  int64_t cycles = top->clock.get_cycles() - top->stats_start_cycle;
+
+  top->stats_trace.msg(vp::Trace::LEVEL_INFO, "Channel %d: bytes=%ld bandwidth=%.3f B/cycle commands=%ld "
+    "core_queue_max=%d core_queue_stalls=%ld (%ld cycles) counter_stalls=%ld (%ld cycles) descriptors=%ld\n",
+    id, stats_bytes, cycles ? (double)stats_bytes / cycles : 0.0, stats_nb_cmd,
+    stats_queue_max, stats_queue_stalls, stats_queue_stall_cycles, stats_alloc_stalls,
+    stats_alloc_stall_cycles, stats_desc);
+
+  if (stats_nb_cmd == 0)
+    return;
+
+  std::string hist;
+  for (int i=0; i<MCHAN_LATENCY_BINS; i++)
+  {
+    if (stats_latency_hist[i])
+      hist += " " + std::to_string(1 << i) + ":" + std::to_string(stats_latency_hist[i]);
+  }
+
+  top->stats_trace.msg(vp::Trace::LEVEL_INFO, "Channel %d: latency avg=%ld max=%ld histogram=%s\n",
+    id, stats_latency_sum / stats_nb_cmd, stats_latency_max, hist.c_str());
 }
 
 /* Check if a raw command is ready and unpack it to make it easier to parse */
@@ -254,18 +408,16 @@ int Mchan_channel::unpack_command(Mchan_cmd *cmd)
 {
   if (cmd->step == 1)
   {
-    cmd->size = MCHAN_CMD_CMD_LEN_GET(cmd->content[0]);
-    cmd->size_to_read = cmd->size;
-    cmd->size_to_write = cmd->size;
-    cmd->received_size = 0;
-    cmd->loc2ext = !MCHAN_CMD_CMD_TYPE_GET(cmd->content[0]);
-    cmd->incr = MCHAN_CMD_CMD_INC_GET(cmd->content[0]);
-    cmd->is_2d = MCHAN_CMD_CMD__2D_EXT_GET(cmd->content[0]);
-    cmd->raise_irq = MCHAN_CMD_CMD_ILE_GET(cmd->content[0]);
-    cmd->raise_event = MCHAN_CMD_CMD_ELE_GET(cmd->content[0]);
-    cmd->broadcast = MCHAN_CMD_CMD_BLE_GET(cmd->content[0]);
+    cmd->unpack_header(cmd->content[0]);
     cmd->counter_id = current_counter;
   }
+  else if (cmd->step == 2 && cmd->is_linked)
+  {
+    cmd->size = 0;
+    cmd->desc_addr = cmd->content[1];
+    top->trace.msg("New linked command ready (input: %d, descriptor: 0x%x, counter: %d)\n", id, cmd->desc_addr, cmd->counter_id);
+    goto unpackDone;
+  }
   else if ((cmd->step == 3 && !top->is_64) || (cmd->step == 4 && top->is_64))
   {
     if (cmd->loc2ext) {
@@ -298,9 +450,19 @@ int Mchan_channel::unpack_command(Mchan_cmd *cmd)
     cmd->source_chunk = cmd->source;
     cmd->dest_chunk = cmd->dest;
 
+   if (cmd->is_3d)
+     return 0;
+
    top->trace.msg("New 2D command ready (input: %d, source: 0x%lx, dest: 0x%lx, size: 0x%x, loc2ext: %d, stride: 0x%x, len: 0x%x)\n", id, cmd->source, cmd->dest, cmd->size, cmd->loc2ext, cmd->stride, cmd->length);
    goto unpackDone;
  }
+ else if ((cmd->step == 7 && !top->is_64) || (cmd->step == 8 && top->is_64))
+ {
+   cmd->start_3d(cmd->content[cmd->step - 2], cmd->content[cmd->step - 1]);
+
+   top->trace.msg("New 3D command ready (input: %d, source: 0x%lx, dest: 0x%lx, size: 0x%x, loc2ext: %d, stride: 0x%x, len: 0x%x, plane_stride: 0x%x, plane_len: 0x%x)\n", id, cmd->source, cmd->dest, cmd->size, cmd->loc2ext, cmd->stride, cmd->length, cmd->plane_stride, cmd->plane_length);
+   goto unpackDone;
+ }
  return 0;
 
  unpackDone:
@@ -363,22 +525,31 @@ Mchan_cmd *Mchan_channel::pop_cmd(bool read_queue)
 {
   Mchan_cmd *cmd = pending_cmds->pop(!read_queue);
   if (cmd == NULL) return NULL;
-  pending_cmd--;
 
   if (cmd->loc2ext)
     top->nb_core_write_cmd--;
   else
     top->nb_core_read_cmd--;
 
+  release_cmd_slot();
+
+  return cmd;
+}
+
+/* Frees a core queue slot and unstalls the core waiting for it, if any */
+void Mchan_channel::release_cmd_slot()
+{
+  pending_cmd--;
+  stats_queue_update();
+
   if (pending_req)
   {
+    stats_queue_stall_cycles += top->clock.get_cycles() - stats_queue_stall_start;
     vp::IoReq *req = pending_req;
     pending_req = NULL;
     handle_req(req, (uint32_t *)req->get_data());
     req->get_resp_port()->resp(req);
   }
-
-  return cmd;
 }
 
 /* This checks if a command is ready after the queue has been written and if it is the case, enqueue it
@@ -389,6 +560,15 @@ bool Mchan_channel::check_command(Mchan_cmd *cmd)
 
   if (!unpack_command(cmd)) return false;
 
+  // Linked commands keep their core queue slot until the whole chain is fetched
+  if (cmd->is_linked)
+  {
+    cmd->push_cycle = top->clock.get_cycles();
+    stats_queue_update();
+    top->push_chain(cmd);
+    return true;
+  }
+
   top->pending_bytes[current_counter] += cmd->size;
 
   top->trace.msg("Incrementing counter (id: %d, bytes: %d, remaining bytes: %d)\n", current_counter, cmd->size, top->pending_bytes[current_counter]);
@@ -397,7 +577,9 @@ bool Mchan_channel::check_command(Mchan_cmd *cmd)
   uint8_t one = 1;
   this->top->cmd_events[cmd->counter_id].event(&one);
 
+  cmd->push_cycle = top->clock.get_cycles();
   pending_cmds->push(cmd);
+  stats_queue_update();
 
   if (cmd->loc2ext)
     top->nb_core_write_cmd++;
@@ -434,6 +616,8 @@ vp::IoReqStatus Mchan_channel::handle_queue_write(vp::IoReq *req, uint32_t *valu
   if (pending_cmd == top->core_queue_depth)
   {
     top->trace.msg("Core queue is full, stalling calling core\n");
+    stats_queue_stalls++;
+    stats_queue_stall_start = top->clock.get_cycles();
     pending_req = req;
     return vp::IO_REQ_PENDING;
   }
@@ -483,6 +667,9 @@ Mchan_channel::Mchan_channel(int id, mchan *top)
 
   top->new_master_port("event_itf_" + std::to_string(id), &event_itf);
   top->new_master_port("irq_itf_" + std::to_string(id), &irq_itf);
+
+  top->traces.new_trace_event("in_" + std::to_string(id) + "/bytes", &bytes_event, 32);
+  top->traces.new_trace_event("in_" + std::to_string(id) + "/core_queue", &queue_event, 8);
 }
 
 vp::IoReqStatus Mchan_channel::req(vp::IoReq *req)
@@ -528,7 +715,7 @@ void mchan::ext_grant(vp::Block *__this, vp::IoReq *req)
 {
   mchan *_this = (mchan *)__this;
   _this->trace.msg("Received grant (req: %p\n", req);
-  _this->ext_is_stalled = false;
+  _this->stats_ext_stall(false);
   _this->check_queue();
 }
 
@@ -568,16 +755,26 @@ mchan::mchan(vp::ComponentConf &config)
   max_nb_ext_write_req = get_js_config()->get_child_int("max_nb_ext_write_req");
   max_burst_length = get_js_config()->get_child_int("max_burst_length");
   nb_loc_ports = get_js_config()->get_child_int("nb_loc_ports");
+  loc_port_width = get_js_config()->get_child_int("loc_port_width");
+  // Beats are split on this width with masks, so it must be a power of 2 of at least one word
+  if (loc_port_width < 4 || (loc_port_width & (loc_port_width - 1)))
+  {
+    throw std::logic_error("Invalid local port width: " + std::to_string(loc_port_width));
+  }
   tcdm_addr_width = get_js_config()->get_child_int("tcdm_addr_width");
+  fast_mode = get_js_config()->get_child_bool("fast_mode");
 
   check_queue_event = event_new(mchan::check_queue_handler);
   check_ext_read_event = event_new(mchan::check_ext_read_handler);
   check_ext_write_event = event_new(mchan::check_ext_write_handler);
   check_loc_transfer_event = event_new(mchan::check_loc_transfer_handler);
+  fast_end_event = event_new(mchan::fast_end_handler);
+  desc_fetch_event = event_new(mchan::desc_fetch_handler);
 
   pending_read_cmds = new Mchan_queue<Mchan_cmd>(global_queue_depth);
   pending_write_cmds = new Mchan_queue<Mchan_cmd>(global_queue_depth);
   pending_write_reqs = new Mchan_queue<vp::IoReq>(global_queue_depth);
+  pending_chain_cmds = new Mchan_queue<Mchan_cmd>(nb_channels * core_queue_depth);
 
   loc_req = new vp::IoReq[nb_loc_ports];
   loc_itf = new vp::IoMaster[nb_loc_ports];
@@ -621,6 +818,7 @@ mchan::mchan(vp::ComponentConf &config)
   }
 
   traces.new_trace("trace", &this->trace, vp::DEBUG);
+  traces.new_trace("stats", &this->stats_trace, vp::DEBUG);
 
   for (int i=0; i<nb_channels; i++)
   {
@@ -633,6 +831,10 @@ mchan::mchan(vp::ComponentConf &config)
   }
 
   this->new_master_port("ext_irq_itf", &ext_irq_itf);
+
+  traces.new_trace_event("ext_stalled", &this->ext_stalled_event, 1);
+  traces.new_trace_event("read_queue", &this->read_queue_event, 8);
+  traces.new_trace_event("write_queue", &this->write_queue_event, 8);
 }
 
 vp::IoReqStatus mchan::req(vp::Block *__this, vp::IoReq *req, int id)
@@ -645,7 +847,7 @@ uint32_t mchan::get_status()
 {
   uint32_t status = 0;
   for (unsigned int i=0; i<MCHAN_NB_COUNTERS; i++) {
-    status |= (pending_bytes[i] != 0) << i;
+    status |= (pending_bytes[i] != 0 || pending_chains[i] != 0) << i;
   }
   status |= ((~free_counter_mask) & ((1 << MCHAN_NB_COUNTERS) - 1)) << 16;
   return status;
@@ -663,7 +865,9 @@ void mchan::free_counters(uint32_t counter_mask)
     first_alloc_pending_req = req->get_next();
 
     // Get the counter and unstall the core
-    *(uint32_t *)req->get_data() = do_alloc_counter((Mchan_channel *)*req->arg_get_last());
+    Mchan_channel *channel = (Mchan_channel *)*req->arg_get_last();
+    channel->stats_alloc_stall_cycles += clock.get_cycles() - channel->stats_alloc_stall_start;
+    *(uint32_t *)req->get_data() = do_alloc_counter(channel);
     req->get_resp_port()->resp(req);
   }
 }
@@ -700,6 +904,9 @@ int mchan::alloc_counter(vp::IoReq *req, Mchan_channel *channel)
     *req->arg_get_last() = channel;
     last_alloc_pending_req = req;
 
+    channel->stats_alloc_stalls++;
+    channel->stats_alloc_stall_start = clock.get_cycles();
+
     return -1;
   }
 }
@@ -740,6 +947,7 @@ void mchan::move_to_global_queue(bool read_queue)
       trace.msg("Moving command from core queue to global queue (channel: %d)\n", j);
 
       queue->push(cmd);
+      stats_queue_update();
 
       sched_core_queue++;
       if (sched_core_queue == nb_channels)
@@ -811,20 +1019,7 @@ void mchan::send_loc_read_req()
   *(uint32_t *)req->arg_get(1) = cmd->source & ((1<<tcdm_addr_width) - 1);
   *(uint32_t *)req->arg_get(2) = 0;
 
-  cmd->dest += size;
-  cmd->source += size;
-  cmd->size_to_read -= size;
-
-  if (cmd->is_2d)
-  {
-    cmd->line_size_to_read -= size;
-    if (cmd->line_size_to_read == 0)
-    {
-      cmd->line_size_to_read = cmd->length;
-      cmd->dest = cmd->dest_chunk + cmd->stride;
-      cmd->dest_chunk = cmd->dest;
-    }
-  }
+  cmd->next_burst(cmd->dest, cmd->dest_chunk, cmd->source, size);
 
   pending_loc_read_req = req;
 
@@ -857,19 +1052,7 @@ void mchan::send_req()
   *(uint32_t *)req->arg_get(1) = cmd->dest & ((1<<tcdm_addr_width) - 1);
   *(uint32_t *)req->arg_get(2) = 0;
 
-  cmd->dest += size;
-  cmd->source += size;
-  cmd->size_to_read -= size;
-  if (cmd->is_2d)
-  {
-    cmd->line_size_to_read -= size;
-    if (cmd->line_size_to_read == 0)
-    {
-      cmd->line_size_to_read = cmd->length;
-      cmd->source = cmd->source_chunk + cmd->stride;
-      cmd->source_chunk = cmd->source;
-    }
-  }
+  cmd->next_burst(cmd->source, cmd->source_chunk, cmd->dest, size);
 
   if (cmd->size_to_read == 0)
   {
@@ -884,7 +1067,7 @@ void mchan::send_req()
   }
   else if (err == vp::IO_REQ_DENIED)
   {
-    ext_is_stalled = true;
+    stats_ext_stall(true);
   }
 }
 
@@ -892,9 +1075,17 @@ void mchan::check_ext_read_handler(vp::Block *__this, vp::ClockEvent *event)
 {
   mchan *_this = (mchan *)__this;
 
-  if (_this->current_ext_read_cmd == NULL)
+  if (_this->current_ext_read_cmd == NULL && _this->fast_cmd == NULL)
+  {
     _this->current_ext_read_cmd = _this->pending_read_cmds->pop();
+    _this->stats_queue_update();
 
+    if (_this->current_ext_read_cmd != NULL && _this->fast_mode &&
+      _this->nb_pending_ext_read_req == 0 && _this->pending_write_reqs->is_empty())
+    {
+      _this->fast_ext2loc(_this->current_ext_read_cmd);
+    }
+  }
 
   if (_this->current_ext_read_cmd != NULL)
   {
@@ -912,8 +1103,17 @@ void mchan::check_ext_write_handler(vp::Block *__this, vp::ClockEvent *event)
 {
   mchan *_this = (mchan *)__this;
 
-  if (_this->current_ext_write_cmd == NULL)
+  if (_this->current_ext_write_cmd == NULL && _this->fast_cmd == NULL)
+  {
     _this->current_ext_write_cmd = _this->pending_write_cmds->pop();
+    _this->stats_queue_update();
+
+    if (_this->current_ext_write_cmd != NULL && _this->fast_mode &&
+      _this->nb_pending_ext_write_req == 0 && _this->pending_loc_read_req == NULL)
+    {
+      _this->fast_loc2ext(_this->current_ext_write_cmd);
+    }
+  }
 
   if (_this->current_ext_write_cmd != NULL)
   {
@@ -930,6 +1130,7 @@ void mchan::check_ext_write_handler(vp::Block *__this, vp::ClockEvent *event)
 
 void mchan::handle_cmd_termination(Mchan_cmd *cmd)
 {
+  cmd->channel->stats_account_cmd(clock.get_cycles() - cmd->push_cycle);
   this->cmd_events[cmd->counter_id].event(NULL);
   free_command(cmd);
 }
@@ -937,26 +1138,206 @@ void mchan::handle_cmd_termination(Mchan_cmd *cmd)
 void mchan::account_transfered_bytes(Mchan_cmd *cmd, int bytes)
 {
   pending_bytes[cmd->counter_id] -= bytes;
+  cmd->channel->stats_account_bytes(bytes);
 
   trace.msg("Decreasing counter (id: %d, bytes: %d, remaining bytes: %d)\n", cmd->counter_id, bytes, pending_bytes[cmd->counter_id]);
 
   if (pending_bytes[cmd->counter_id] < 0)
     this->trace.force_warning("Counter became negative (id: %d, count: %d)\n", cmd->counter_id, pending_bytes[cmd->counter_id]);
 
-  if (pending_bytes[cmd->counter_id] == 0)
+  if (pending_bytes[cmd->counter_id] == 0 && pending_chains[cmd->counter_id] == 0)
   {
-    trace.msg("Counter reached zero, raising event\n");
+    raise_counter_event(cmd);
+  }
+}
+
+void mchan::raise_counter_event(Mchan_cmd *cmd)
+{
+  trace.msg("Counter reached zero, raising event\n");
+
+  if (cmd->broadcast)
+  {
+    for (unsigned int i=0; i<nb_channels; i++)
+      channels[i]->trigger_event(cmd);
+  }
+  else
+  {
+    cmd->channel->trigger_event(cmd);
+  }
+}
+
+// Sends a beat to a local port as one request per word, since each word may target a
+// different bank, and returns the latency of the slowest one, or -1 if one of them did
+// not respond synchronously.
+int64_t mchan::send_loc_beat(int port, uint32_t addr, uint8_t *data, int32_t size, bool is_write)
+{
+  vp::IoReq *req = &loc_req[port];
+  int64_t latency = 0;
+  bool is_sync = true;
+  for (int32_t word_done = 0; word_done < size; )
+  {
+    uint32_t word_addr = addr + word_done;
+    int32_t word_size = 4 - (word_addr & 0x3);
+    if (word_size > size - word_done) word_size = size - word_done;
+
+    // Create request to local port
+    trace.msg("Sending %s request to local port (req: %p, port: %d, addr: 0x%x, size: 0x%x)\n",
+      is_write ? "write" : "read", req, port, word_addr, word_size);
+    req->init();
+    req->set_addr(word_addr);
+    req->set_size(word_size);
+    req->set_is_write(is_write);
+    req->set_data(data + word_done);
 
-    if (cmd->broadcast)
+    // Send the request to the local port
+    // TODO for now we assume this is synchronous
+    vp::IoReqStatus err = loc_itf[port].req(req);
+
+    if (err)
     {
-      for (unsigned int i=0; i<nb_channels; i++)
-        channels[i]->trigger_event(cmd);
+      is_sync = false;
     }
-    else
+    else if (req->get_latency() > latency)
     {
-      cmd->channel->trigger_event(cmd);
+      latency = req->get_latency();
     }
+
+    word_done += word_size;
+  }
+
+  return is_sync ? latency : -1;
+}
+
+// Moves a whole burst between an external request buffer and the local memory, spreading
+// the beats over the local ports of this direction, and returns the number of cycles the
+// ports would be busy with it.
+int64_t mchan::fast_loc_burst(vp::IoReq *ext_req, bool is_write)
+{
+  int first_port = is_write ? 0 : nb_loc_ports/2;
+  int nb_ports = nb_loc_ports/2;
+  uint32_t addr = *(uint32_t *)ext_req->arg_get(1);
+  int32_t ext_size = ext_req->get_size();
+  int64_t latency = 0;
+  int nb_beats = 0;
+
+  for (int32_t done = 0; done < ext_size; nb_beats++)
+  {
+    int32_t size = loc_port_width - ((addr + done) & (loc_port_width - 1));
+    if (size > ext_size - done) size = ext_size - done;
+
+    int64_t beat_latency = send_loc_beat(first_port + nb_beats % nb_ports, addr + done,
+      ext_req->get_data() + done, size, is_write);
+    if (beat_latency > latency)
+      latency = beat_latency;
+
+    done += size;
   }
+
+  return (nb_beats + nb_ports - 1) / nb_ports * (latency + 1);
+}
+
+// Fast mode for ext2loc commands. Bursts are read from the external interface and directly
+// copied to the local memory as long as the external interface responds synchronously.
+// The first burst which does not leaves the rest of the command to the accurate path.
+void mchan::fast_ext2loc(Mchan_cmd *cmd)
+{
+  int done_size = 0;
+  int64_t ext_latency = 0;
+  int64_t loc_cycles = 0;
+  int nb_bursts = 0;
+
+  while (current_ext_read_cmd == cmd && !ext_is_stalled)
+  {
+    this->send_req();
+
+    vp::IoReq *req = pending_write_reqs->pop();
+    if (req == NULL)
+      break;
+
+    if (req->get_latency() > ext_latency)
+      ext_latency = req->get_latency();
+    loc_cycles += fast_loc_burst(req, true);
+    nb_bursts++;
+
+    cmd->size_to_write -= req->get_size();
+    done_size += req->get_size();
+
+    req->set_next(first_ext_read_req);
+    first_ext_read_req = req;
+    nb_pending_ext_read_req--;
+  }
+
+  // Bursts are issued one per cycle while the local ports drain them
+  this->fast_cmd_end(cmd, done_size, ext_latency + std::max(loc_cycles, (int64_t)nb_bursts));
+}
+
+// Fast mode for loc2ext commands, same as above with local reads followed by external writes
+void mchan::fast_loc2ext(Mchan_cmd *cmd)
+{
+  int done_size = 0;
+  int64_t ext_latency = 0;
+  int64_t loc_cycles = 0;
+  int nb_bursts = 0;
+
+  while (current_ext_write_cmd == cmd)
+  {
+    this->send_loc_read_req();
+
+    vp::IoReq *req = pending_loc_read_req;
+    pending_loc_read_req = NULL;
+
+    loc_cycles += fast_loc_burst(req, false);
+    nb_bursts++;
+
+    if (ext_itf.req(req) != vp::IO_REQ_OK)
+    {
+      // The response will go through handle_ext_write_req_end
+      break;
+    }
+
+    if (req->get_latency() > ext_latency)
+      ext_latency = req->get_latency();
+
+    cmd->size_to_write -= req->get_size();
+    done_size += req->get_size();
+
+    req->set_next(first_ext_write_req);
+    first_ext_write_req = req;
+    nb_pending_ext_write_req--;
+  }
+
+  this->fast_cmd_end(cmd, done_size, ext_latency + std::max(loc_cycles, (int64_t)nb_bursts));
+}
+
+void mchan::fast_cmd_end(Mchan_cmd *cmd, int done_size, int64_t latency)
+{
+  if (cmd->size_to_write == 0)
+  {
+    // Everything was copied, the counter and the channel event are updated at the
+    // cycle where the accurate model would have finished
+    trace.msg("Fast command done (size: 0x%x, latency: %ld)\n", done_size, latency);
+    fast_cmd = cmd;
+    event_enqueue(fast_end_event, latency > 0 ? latency : 1);
+  }
+  else if (done_size)
+  {
+    // The accurate path takes over, account what was already copied
+    trace.msg("Falling back to accurate mode (done: 0x%x, remaining: 0x%x)\n",
+      done_size, cmd->size_to_write);
+    account_transfered_bytes(cmd, done_size);
+  }
+}
+
+void mchan::fast_end_handler(vp::Block *__this, vp::ClockEvent *event)
+{
+  mchan *_this = (mchan *)__this;
+  Mchan_cmd *cmd = _this->fast_cmd;
+
+  _this->fast_cmd = NULL;
+  _this->account_transfered_bytes(cmd, cmd->size);
+  _this->handle_cmd_termination(cmd);
+
+  _this->check_queue();
 }
 
 void mchan::check_loc_transfer_handler(vp::Block *__this, vp::ClockEvent *event)
@@ -1004,31 +1385,15 @@ void mchan::check_loc_transfer_handler(vp::Block *__this, vp::ClockEvent *event)
     int32_t ext_size = ext_req->get_size() - done_size;
     uint32_t addr = *(uint32_t *)ext_req->arg_get(1) + done_size;
     uint8_t *data = ext_req->get_data() + done_size;
-    int32_t size = 4;
-    if (addr & 0x3) size -= addr & 0x3;
+    int32_t size = _this->loc_port_width;
+    if (addr & (_this->loc_port_width - 1)) size -= addr & (_this->loc_port_width - 1);
     if (size > ext_size) size = ext_size;
 
-    // Create request to local port
-    vp::IoReq *req = &_this->loc_req[i];
-    _this->trace.msg("Sending %s request to local port (req: %p, port: %d, addr: 0x%x, size: 0x%x)\n",
-      is_write ? "write" : "read", req, i, addr, size);
-    req->init();
-    req->set_addr(addr);
-    req->set_size(size);
-    req->set_is_write(is_write);
-    req->set_data(data);
-
-    // Send the request to the local port
-    // TODO for now we assume this is synchronous
-    vp::IoReqStatus err = _this->loc_itf[i].req(req);
-
-    if (err)
-    {
-
-    }
-    else
+    // The port is busy until the slowest word of the beat is done
+    int64_t latency = _this->send_loc_beat(i, addr, data, size, is_write);
+    if (latency != -1)
     {
-      _this->loc_port_ready_cycle[i] = cycles + req->get_latency() + 1;
+      _this->loc_port_ready_cycle[i] = cycles + latency + 1;
     }
 
     if (is_write)
@@ -1107,7 +1472,7 @@ void mchan::check_queue()
       event_enqueue(check_queue_event, 1);
   }
 
-  if (!pending_read_cmds->is_empty() && current_ext_read_cmd == NULL ||
+  if (!pending_read_cmds->is_empty() && current_ext_read_cmd == NULL && fast_cmd == NULL ||
     current_ext_read_cmd != NULL && nb_pending_ext_read_req < max_nb_ext_read_req)
   {
     if (!ext_is_stalled)
@@ -1117,7 +1482,7 @@ void mchan::check_queue()
     }
   }
 
-  if (!pending_write_cmds->is_empty() && current_ext_write_cmd == NULL ||
+  if (!pending_write_cmds->is_empty() && current_ext_write_cmd == NULL && fast_cmd == NULL ||
     current_ext_write_cmd != NULL && nb_pending_ext_write_req < max_nb_ext_write_req &&
     pending_loc_read_req == NULL)
   {
@@ -1128,6 +1493,20 @@ void mchan::check_queue()
     }
   }
 
+  if (!desc_fetch_event->is_enqueued())
+  {
+    if (desc_cmd != NULL)
+    {
+      if (!(desc_cmd->loc2ext ? pending_write_cmds : pending_read_cmds)->is_full())
+        event_enqueue(desc_fetch_event, 1);
+    }
+    else if (current_chain_cmd != NULL || !pending_chain_cmds->is_empty())
+    {
+      int64_t ready_cycle = loc_port_ready_cycle[nb_loc_ports - 1] - clock.get_cycles();
+      event_enqueue(desc_fetch_event, ready_cycle > 1 ? ready_cycle : 1);
+    }
+  }
+
   if (!pending_write_reqs->is_empty() || pending_loc_read_req != NULL)
   {
     if (!check_loc_transfer_event->is_enqueued())
@@ -1154,6 +1533,207 @@ void mchan::check_queue()
   }
 }
 
+void mchan::stats_queue_update()
+{
+  uint8_t value = pending_read_cmds->get_nb_cmd();
+  read_queue_event.event(&value);
+  if (value > stats_read_queue_max)
+    stats_read_queue_max = value;
+
+  value = pending_write_cmds->get_nb_cmd();
+  write_queue_event.event(&value);
+  if (value > stats_write_queue_max)
+    stats_write_queue_max = value;
+}
+
+void mchan::stats_ext_stall(bool stalled)
+{
+  if (stalled == ext_is_stalled)
+    return;
+
+  if (stalled)
+  {
+    stats_ext_stalls++;
+    stats_ext_stall_start = clock.get_cycles();
+  }
+  else
+  {
+    stats_ext_stall_cycles += clock.get_cycles() - stats_ext_stall_start;
+  }
+
+  ext_is_stalled = stalled;
+  uint8_t value = stalled;
+  ext_stalled_event.event(&value);
+}
+
+void mchan::push_chain(Mchan_cmd *chain)
+{
+  pending_chains[chain->counter_id]++;
+  pending_chain_cmds->push(chain);
+  check_queue();
+}
+
+// Fetches the next descriptor of a chain through the last local port, which is shared
+// with the local reads of loc2ext transfers, so that descriptor fetches consume local
+// bandwidth. The command built from it is then pushed to the global queues like a
+// command coming from a core queue.
+void mchan::fetch_desc(Mchan_cmd *chain)
+{
+  int port = nb_loc_ports - 1;
+  uint32_t desc[MCHAN_DESC_NB_WORDS];
+  uint32_t addr = chain->desc_addr & ((1<<tcdm_addr_width) - 1);
+  int32_t desc_size = sizeof(desc);
+  int64_t latency = 0;
+  int nb_beats = 0;
+
+  trace.msg("Fetching descriptor (addr: 0x%x, counter: %d)\n", chain->desc_addr, chain->counter_id);
+
+  for (int32_t done = 0; done < desc_size; nb_beats++)
+  {
+    int32_t size = loc_port_width - ((addr + done) & (loc_port_width - 1));
+    if (size > desc_size - done) size = desc_size - done;
+
+    int64_t beat_latency = send_loc_beat(port, addr + done, (uint8_t *)desc + done, size, false);
+    if (beat_latency > latency)
+      latency = beat_latency;
+
+    done += size;
+  }
+
+  // The beats go through a single port so they are serialized
+  loc_port_ready_cycle[port] = clock.get_cycles() + nb_beats * (latency + 1);
+
+  Mchan_cmd *cmd = get_command();
+  cmd->unpack_header(desc[0]);
+  cmd->channel = chain->channel;
+  cmd->counter_id = chain->counter_id;
+  cmd->raise_irq = chain->raise_irq;
+  cmd->raise_event = chain->raise_event;
+  cmd->broadcast = chain->broadcast;
+  cmd->push_cycle = clock.get_cycles();
+
+  if (cmd->loc2ext)
+  {
+    cmd->source = desc[1];
+    cmd->dest = desc[2];
+  }
+  else
+  {
+    cmd->dest = desc[1];
+    cmd->source = desc[2];
+  }
+
+  if (cmd->is_2d)
+  {
+    cmd->length = desc[3];
+    cmd->stride = desc[4];
+    cmd->line_size_to_read = cmd->length;
+    cmd->source_chunk = cmd->source;
+    cmd->dest_chunk = cmd->dest;
+  }
+
+  if (cmd->is_3d)
+  {
+    cmd->start_3d(desc[5], desc[6]);
+  }
+
+  trace.msg("New command from descriptor (source: 0x%lx, dest: 0x%lx, size: 0x%x, loc2ext: %d, 2d: %d, 3d: %d)\n",
+    cmd->source, cmd->dest, cmd->size, cmd->loc2ext, cmd->is_2d, cmd->is_3d);
+
+  chain->channel->stats_desc++;
+
+  // Empty descriptors have no byte to transfer and are dropped here, since nothing
+  // would account them in the counter
+  if (cmd->size == 0)
+  {
+    free_command(cmd);
+  }
+  else
+  {
+    pending_bytes[cmd->counter_id] += cmd->size;
+    uint8_t one = 1;
+    cmd_events[cmd->counter_id].event(&one);
+    desc_cmd = cmd;
+  }
+
+  chain->desc_addr = desc[MCHAN_DESC_NEXT];
+  if (chain->desc_addr == 0)
+  {
+    end_chain(chain);
+  }
+}
+
+// The chain is over, its core queue slot can be reused and its counter can now
+// reach zero once the bytes of its commands are transfered. If they already are,
+// for example because the last descriptors are empty, the counter event is raised here.
+void mchan::end_chain(Mchan_cmd *chain)
+{
+  trace.msg("Finished descriptor chain (counter: %d)\n", chain->counter_id);
+  current_chain_cmd = NULL;
+  pending_chains[chain->counter_id]--;
+
+  if (pending_bytes[chain->counter_id] == 0 && pending_chains[chain->counter_id] == 0)
+  {
+    raise_counter_event(chain);
+  }
+
+  chain->channel->release_cmd_slot();
+  free_command(chain);
+}
+
+void mchan::push_desc_cmd()
+{
+  Mchan_queue<Mchan_cmd> *queue = desc_cmd->loc2ext ? pending_write_cmds : pending_read_cmds;
+
+  if (!queue->is_full())
+  {
+    queue->push(desc_cmd);
+    stats_queue_update();
+    desc_cmd = NULL;
+  }
+}
+
+void mchan::desc_fetch_handler(vp::Block *__this, vp::ClockEvent *event)
+{
+  mchan *_this = (mchan *)__this;
+
+  if (_this->desc_cmd == NULL)
+  {
+    if (_this->current_chain_cmd == NULL)
+      _this->current_chain_cmd = _this->pending_chain_cmds->pop();
+
+    // A null head pointer is an empty chain, which is terminated without any fetch
+    if (_this->current_chain_cmd != NULL && _this->current_chain_cmd->desc_addr == 0)
+    {
+      _this->end_chain(_this->current_chain_cmd);
+    }
+    else if (_this->current_chain_cmd != NULL &&
+      _this->loc_port_ready_cycle[_this->nb_loc_ports - 1] <= _this->clock.get_cycles())
+    {
+      _this->fetch_desc(_this->current_chain_cmd);
+    }
+  }
+
+  if (_this->desc_cmd != NULL)
+  {
+    _this->push_desc_cmd();
+  }
+
+  _this->check_queue();
+}
+
+void mchan::stop()
+{
+  stats_trace.msg(vp::Trace::LEVEL_INFO, "External interface: stalls=%ld (%ld cycles), "
+    "read_queue_max=%d write_queue_max=%d\n", stats_ext_stalls, stats_ext_stall_cycles,
+    stats_read_queue_max, stats_write_queue_max);
+
+  for (int i=0; i<nb_channels; i++)
+  {
+    channels[i]->stats_report();
+  }
+}
+
 void mchan::reset(bool active)
 {
   if (active)
@@ -1163,6 +1743,7 @@ void mchan::reset(bool active)
     for (int i=0; i<MCHAN_NB_COUNTERS; i++)
     {
       pending_bytes[i] = 0;
+      pending_chains[i] = 0;
     }
 
     for (int i=0; i<nb_channels; i++)
@@ -1189,7 +1770,16 @@ void mchan::reset(bool active)
     current_ext_write_cmd = NULL;
     current_loc_cmd = NULL;
     pending_loc_read_req = NULL;
+    fast_cmd = NULL;
+    pending_chain_cmds->init();
+    current_chain_cmd = NULL;
+    desc_cmd = NULL;
     ext_is_stalled = false;
+    stats_start_cycle = clock.get_cycles();
+    stats_ext_stalls = 0;
+    stats_ext_stall_cycles = 0;
+    stats_read_queue_max = 0;
+    stats_write_queue_max = 0;
     for (int i=0; i<MCHAN_NB_COUNTERS; i++)
     {
       this->cmd_events[i].event(NULL);
@@ -1205,6 +1795,62 @@ void Mchan_cmd::init()
   step = 0;
 }
 
+void Mchan_cmd::unpack_header(uint32_t value)
+{
+  size = MCHAN_CMD_CMD_LEN_GET(value);
+  size_to_read = size;
+  size_to_write = size;
+  received_size = 0;
+  loc2ext = !MCHAN_CMD_CMD_TYPE_GET(value);
+  incr = MCHAN_CMD_CMD_INC_GET(value);
+  is_3d = MCHAN_CMD_CMD__3D_EXT_GET(value);
+  // 3D transfers are 2D transfers whose lines also wrap to the next plane
+  is_2d = MCHAN_CMD_CMD__2D_EXT_GET(value) || is_3d;
+  is_linked = MCHAN_CMD_CMD_LINKED_GET(value);
+  raise_irq = MCHAN_CMD_CMD_ILE_GET(value);
+  raise_event = MCHAN_CMD_CMD_ELE_GET(value);
+  broadcast = MCHAN_CMD_CMD_BLE_GET(value);
+}
+
+void Mchan_cmd::start_3d(uint32_t length, uint32_t stride)
+{
+  plane_length = length;
+  plane_stride = stride;
+  plane_size_to_read = length;
+  plane_chunk = loc2ext ? dest : source;
+}
+
+// Moves the addresses after a burst. Only the external side is strided, the local
+// side is always contiguous.
+void Mchan_cmd::next_burst(uint64_t &ext, uint64_t &ext_chunk, uint64_t &loc, int size)
+{
+  ext += size;
+  loc += size;
+  size_to_read -= size;
+
+  if (is_2d)
+  {
+    line_size_to_read -= size;
+    if (line_size_to_read == 0)
+    {
+      line_size_to_read = length;
+
+      plane_size_to_read -= length;
+      if (is_3d && plane_size_to_read == 0)
+      {
+        plane_size_to_read = plane_length;
+        ext = plane_chunk + plane_stride;
+        plane_chunk = ext;
+      }
+      else
+      {
+        ext = ext_chunk + stride;
+      }
+      ext_chunk = ext;
+    }
+  }
+}
+
 extern "C" vp::Component *gv_new(vp::ComponentConf &config)
 {
   return new mchan(config);
@@ -31,6 +31,8 @@
 #include <assert.h>
 #include <string>
 #include <bitset>
+#include <array>
+#include <vector>
 #include "xtensor/xarray.hpp"
 #include "xtensor/xio.hpp"
 #include "xtensor/xview.hpp"
@@ -66,6 +68,8 @@
 #define NE16_REG_CONFIG0           23
 
 #define NE16_NB_REG 24
+// Size of the address range of the HWPE slave port, which holds the direct context windows
+#define NE16_SLAVE_SIZE 0x400
 
 #define NE16_SPECIAL_TRACE_REG NE16_NB_REG
 #define NE16_SPECIAL_FORMAT_TRACE_REG NE16_NB_REG+1
@@ -87,6 +91,8 @@ enum Ne16State {
     END
 };
 
+#define NE16_NB_STATES (END+1)
+
 enum Ne16TraceLevel {
     L0_CONFIG,
     L1_ACTIV_INOUT,
@@ -196,6 +202,11 @@ public:
     vp::IoMaster out;
     vp::reg_32 state;
     vp::reg_8 activity;
+    vp::reg_8 job_queue;
+
+    // PERFORMANCE counters of the running job, streamer latencies are accumulated by the streamers
+    int64_t perf_load_latency;
+    int64_t perf_store_latency;
     Ne16TraceLevel trace_level;
     int trace_format;
 
@@ -237,6 +248,17 @@ private:
     void debug_accum();
     void debug_psum_block();
 
+    // PERFORMANCE counters
+    void perf_setup();
+    void perf_clear();
+    void perf_report(int job_id);
+    int64_t perf_state_cycles[NE16_NB_STATES];
+    int64_t perf_job_start;
+    vp::Trace perf_state_events[NE16_NB_STATES];
+    vp::Trace perf_job_cycles_event;
+    vp::Trace perf_load_latency_event;
+    vp::Trace perf_store_latency_event;
+
     // EVENT handlers
     static void fsm_start_handler(vp::Block *__this, vp::ClockEvent *event);
     static void fsm_handler(vp::Block *__this, vp::ClockEvent *event);
@@ -257,16 +279,21 @@ private:
     void printout();
 
     // REGISTER FILE and HWPE CTRL
-    int  cxt0[NE16_NB_REG];
-    int  cxt1[NE16_NB_REG];
+    std::vector<std::array<int, NE16_NB_REG>> cxt; // one register context per job queue slot
     int  cxt_cfg_ptr;
     int  cxt_use_ptr;
     int  job_pending;
     int  job_state;
     unsigned char job_id;
-    int cxt_job_id[2];
+    std::vector<int> cxt_job_id;
     char running_job_id;
     int  job_running;
+    int  nb_jobs;               // depth of the job queue, i.e. number of register contexts
+    uint32_t reg_mask;          // slave address bits decoded, covers the direct windows of all contexts
+    bool job_preload;           // next context is copied in while the current job streams out
+    int  job_preload_credit;    // cycles of the previous job's last streamout still hiding control overheads
+    int  streamout_tile_cycles; // cycles spent in STREAMOUT for the current tile
+    int  preload_overlap(int latency);
 
     // REGISTER FILE configuration parameters
     int weights_ptr;
@@ -391,6 +418,7 @@ private:
     
     // STREAMOUT
     void streamout_setup();
+    bool streamout_clip_bounds(int64_t&, int64_t&);
     int  streamout_cycle();
     bool streamout_exit_idx();
     void streamout_update_idx();
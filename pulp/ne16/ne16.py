@@ -18,12 +18,17 @@ import gvsoc.systree as st
 
 class Ne16(st.Component):
 
-    def __init__(self, parent, name):
+    def __init__(self, parent, name, nb_jobs: int=2, job_preload: bool=False):
 
         super(Ne16, self).__init__(parent, name)
 
         self.set_component('pulp.ne16.ne16')
 
+        self.add_properties({
+            'nb_jobs': nb_jobs,
+            'job_preload': job_preload,
+        })
+
     def gen_gtkw(self, tree, traces):
         if tree.get_view() == 'overview':
             map_file = tree.new_map_file(self, 'state')
@@ -48,6 +53,7 @@ class Ne16(st.Component):
             map_file.add_value(12, 'CadetBlue', 'END')
 
             tree.add_trace(self, self.name, 'fsm_state', '[31:0]', map_file=map_file, tag='overview')
+            tree.add_trace(self, 'job_queue', 'job_queue', '[7:0]', tag='overview')
 
     def gen_gtkw_conf(self, tree, traces):
         if tree.get_view() == 'overview':
@@ -42,9 +42,34 @@ Ne16::Ne16(vp::ComponentConf &config)
     this->OVERHEAD_MV     = 17;
     this->QUANT_PER_CYCLE = 4;
 
+    this->nb_jobs         = this->get_js_config()->get_child_int("nb_jobs");
+    this->job_preload     = this->get_js_config()->get_child_bool("job_preload");
+
     this->traces.new_trace("trace", &this->trace, vp::DEBUG);
+
+    // Registers start at 0x20 with the current context, followed by one direct window per
+    // context, which must all fit in the slave address range
+    uint32_t window_end = 0x20 + (this->nb_jobs + 1) * NE16_NB_REG * 4;
+    if (this->nb_jobs < 1 || window_end > NE16_SLAVE_SIZE)
+    {
+        this->trace.fatal("Invalid number of jobs (nb_jobs: %d, max: %d)\n", this->nb_jobs,
+            (NE16_SLAVE_SIZE - 0x20) / (NE16_NB_REG * 4) - 1);
+        return;
+    }
+    this->reg_mask = 1;
+    while (this->reg_mask < window_end)
+    {
+        this->reg_mask <<= 1;
+    }
+    this->reg_mask -= 1;
+
+    this->cxt.resize(this->nb_jobs);
+    this->cxt_job_id.resize(this->nb_jobs);
     this->new_reg("fsm_state", &this->state, 32);
     this->new_reg("ne16_busy", &this->activity, 8);
+    this->new_reg("job_queue", &this->job_queue, 8);
+    this->job_queue.set(0);
+    this->perf_setup();
     this->activity.set(0);
     this->state.set(IDLE);
 
@@ -77,7 +102,14 @@ void Ne16::reset(bool active)
     this->weight          = xt::zeros<uint8_t>({this->FILTER_SIZE*this->FILTER_SIZE, 2});
     this->nqs             = xt::zeros<uint8_t>({this->TP_OUT});
     this->job_id          = 0;
-    this->cxt_job_id[0] = this->cxt_job_id[1] = -1;
+    std::fill(this->cxt_job_id.begin(), this->cxt_job_id.end(), -1);
+    this->cxt_cfg_ptr     = 0;
+    this->cxt_use_ptr     = 0;
+    this->job_pending     = 0;
+    this->job_state       = 0;
+    this->job_queue.set(0);
+    this->job_preload_credit = 0;
+    this->streamout_tile_cycles = 0;
     this->running_job_id  = 0;
     this->job_running     = 0;
 }
@@ -118,7 +150,7 @@ vp::IoReqStatus Ne16::hwpe_slave(vp::Block *__this, vp::IoReq *req)
             _this->trace.msg("Setting tracing format to %s\n", *data?"Hex":"Dec");
             return vp::IO_REQ_OK;
         }
-        else if((req->get_addr() & 0x17f) == 0x0) {
+        else if((req->get_addr() & _this->reg_mask) == 0x0) {
             _this->commit();
             if (!_this->job_running && !_this->fsm_start_event->is_enqueued() && *(uint32_t *) data == 0) {
                 _this->event_enqueue(_this->fsm_start_event, 1);
@@ -126,25 +158,30 @@ vp::IoReqStatus Ne16::hwpe_slave(vp::Block *__this, vp::IoReq *req)
         }
         else {
             if (_this->trace_level == L1_ACTIV_INOUT || _this->trace_level == L2_DEBUG || _this->trace_level == L3_ALL) {
-                _this->trace.msg(vp::Trace::LEVEL_DEBUG, "offset: %d data: %08x\n", ((req->get_addr() & 0x17f) - 0x20) >> 2, *(uint32_t *) data);
+                _this->trace.msg(vp::Trace::LEVEL_DEBUG, "offset: %d data: %08x\n", ((req->get_addr() & _this->reg_mask) - 0x20) >> 2, *(uint32_t *) data);
             }
-            _this->regfile_wr(((req->get_addr() & 0x17f) - 0x20)>> 2, *(uint32_t *) data);
+            _this->regfile_wr(((req->get_addr() & _this->reg_mask) - 0x20)>> 2, *(uint32_t *) data);
         }
     }
     else {
-        if((req->get_addr() & 0x17f) == 0x4) {
+        if((req->get_addr() & _this->reg_mask) == 0x4) {
             *(uint32_t *) data = _this->acquire();
             if (_this->trace_level == L1_ACTIV_INOUT || _this->trace_level == L2_DEBUG || _this->trace_level == L3_ALL) {
                 _this->trace.msg("Returning %x\n", *(uint32_t *) data);
             }
         }
-        else if((req->get_addr() & 0x17f) == 0xc) {
-            *(uint32_t *) data = ((_this->cxt_job_id[0]>=0?0x1:0)|(_this->cxt_job_id[1]>=0?0x100:0));
+        else if((req->get_addr() & _this->reg_mask) == 0xc) {
+            // one status byte per context, only the first 4 contexts fit in the register
+            uint32_t status = 0;
+            for(auto i=0; i<_this->nb_jobs && i<4; i++) {
+                status |= (_this->cxt_job_id[i]>=0 ? 0x1 : 0) << (i*8);
+            }
+            *(uint32_t *) data = status;
             if (_this->trace_level == L1_ACTIV_INOUT || _this->trace_level == L2_DEBUG || _this->trace_level == L3_ALL) {
                 _this->trace.msg("Returning %x\n", *(uint32_t *) data);
             }
         }
-        else if((req->get_addr() & 0x17f) == 0x10) {
+        else if((req->get_addr() & _this->reg_mask) == 0x10) {
             // Returns the active running job or the last jobid that was run
             *(uint32_t *) data = _this->running_job_id;
             if (_this->trace_level == L1_ACTIV_INOUT || _this->trace_level == L2_DEBUG || _this->trace_level == L3_ALL) {
@@ -152,7 +189,7 @@ vp::IoReqStatus Ne16::hwpe_slave(vp::Block *__this, vp::IoReq *req)
             }
         }
         else {
-            *(uint32_t *) data = _this->regfile_rd(((req->get_addr() & 0x17f) - 0x20) >> 2);
+            *(uint32_t *) data = _this->regfile_rd(((req->get_addr() & _this->reg_mask) - 0x20) >> 2);
             if (_this->trace_level == L1_ACTIV_INOUT || _this->trace_level == L2_DEBUG || _this->trace_level == L3_ALL) {
                 _this->trace.msg("Returning %x\n", *(uint32_t *) data);
             }
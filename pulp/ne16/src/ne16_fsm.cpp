@@ -31,6 +31,7 @@ void Ne16::fsm_start_handler(vp::Block *__this, vp::ClockEvent *event) {
   // clear state and propagate context
   _this->clear_all();
   _this->regfile_cxt();
+  _this->perf_clear();
   _this->job_running = 1;
 
   // convenience parameters used internally in the model, but not set by register file
@@ -91,16 +92,26 @@ void Ne16::fsm_end_handler(vp::Block *__this, vp::ClockEvent *event) {
   int job_id = _this->cxt_job_id[_this->cxt_use_ptr];
   _this->job_running = 0;
   _this->cxt_job_id[_this->cxt_use_ptr] = -1;
-  _this->cxt_use_ptr = 1-_this->cxt_use_ptr;
+  _this->cxt_use_ptr = (_this->cxt_use_ptr + 1) % _this->nb_jobs;
   _this->job_pending--;
+  _this->job_queue.set(_this->job_pending);
   _this->irq.sync(true);
   _this->trace.msg(vp::Trace::LEVEL_INFO, "Ending job (id=%d).\n", job_id);
+  _this->perf_report(job_id);
+  _this->activity.set(0);
+  _this->state.set(IDLE);
   if (!_this->fsm_start_event->is_enqueued() && _this->job_pending > 0) {
+    if (_this->job_preload) {
+      // the next context was copied in during the last streamout, so there is no inter-job bubble
+      _this->job_preload_credit = _this->streamout_tile_cycles;
+      _this->trace.msg(vp::Trace::LEVEL_INFO, "Starting a preloaded job from the queue.\n");
+      Ne16::fsm_start_handler(_this, NULL);
+    }
+    else {
       _this->event_enqueue(_this->fsm_start_event, 1);
       _this->trace.msg(vp::Trace::LEVEL_INFO, "Starting a new job from the queue.\n");
+    }
   }
-  _this->activity.set(0);
-  _this->state.set(IDLE);
 }
 
 void Ne16::fsm_loop() {
@@ -116,6 +127,14 @@ void Ne16::fsm_loop() {
   }
 }
 
+// Hides a fixed control overhead of the first tile of a preloaded job behind
+// the final streamout of the previous job, returns the remaining latency
+int Ne16::preload_overlap(int latency) {
+  auto hidden = std::min(latency, this->job_preload_credit);
+  this->job_preload_credit -= hidden;
+  return latency - hidden;
+}
+
 int Ne16::fsm() {
   auto state_next = this->state.get();
   auto latency = 0;
@@ -168,6 +187,7 @@ int Ne16::fsm() {
         this->trace.msg(vp::Trace::LEVEL_DEBUG, "State START_STREAMIN\n");
       }
       this->constant_setup();
+      this->streamout_tile_cycles = 0;
       if(this->streamin) {
         this->streamin_setup();
         state_next = STREAMIN;
@@ -220,7 +240,7 @@ int Ne16::fsm() {
       state_next = LOAD;
 
       // emulate 6 cycles of latency due to FIFOs + ctrl
-      latency += 6;
+      latency += this->preload_overlap(6);
       break;
       
     case LOAD:
@@ -282,10 +302,10 @@ int Ne16::fsm() {
 
       // emulate 6 cycles of latency due to FIFOs + ctrl (10 for 1x1 layers)
       if(this->depthwise && this->dw_iter == 0) {
-        latency += 22;
+        latency += this->preload_overlap(22);
       }
       else if(!this->depthwise) {
-        latency += this->fs == 1 ? 10 : 6;
+        latency += this->preload_overlap(this->fs == 1 ? 10 : 6);
       }
 
       break;
@@ -397,6 +417,7 @@ int Ne16::fsm() {
         this->trace.msg(vp::Trace::LEVEL_DEBUG, "  streamout_i_out_iter=%d\n", this->streamout_i_out_iter);
         this->trace.msg(vp::Trace::LEVEL_DEBUG, "  streamout_j_out_iter=%d\n", this->streamout_j_out_iter);
       }
+      this->job_preload_credit = 0;
       latency = this->streamout_cycle();
       if(this->streamout_exit_idx()) {
 
@@ -423,6 +444,7 @@ int Ne16::fsm() {
       else {
         this->streamout_update_idx();
       }
+      this->streamout_tile_cycles += latency;
       break;
 
     case END:
@@ -434,6 +456,7 @@ int Ne16::fsm() {
 
   }
 
+  this->perf_state_cycles[this->state.get()] += latency;
   this->state.set(state_next);
   return latency;
 }
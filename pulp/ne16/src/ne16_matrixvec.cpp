@@ -19,42 +19,43 @@
  */
 
 #include <ne16.hpp>
+#include <string.h>
 
-// as the internal max precision of NE16 is 32 bits, this is emulated by casting x to 32 bits here
-xt::xarray<int64_t> __NormQuant(
-  xt::xarray<int64_t> x,
-  xt::xarray<int32_t> kappa_bn,
-  xt::xarray<int32_t> lambda_bn,
-  int32_t shift_reqnt,
-  int clip_min,
-  int clip_max,
-  bool use_rounding,
-  bool use_clip,
-  bool use_cast
-) {
-  if(use_clip) {
-    if(use_cast)
-      return xt::clip((xt::cast<int32_t>(x) * kappa_bn + lambda_bn + (use_rounding ? 1<<(shift_reqnt-1) : 0)) >> shift_reqnt, clip_min, clip_max);
-    else
-      return xt::clip((x * kappa_bn + lambda_bn + (use_rounding ? 1<<(shift_reqnt-1) : 0)) >> shift_reqnt, clip_min, clip_max);
+// byte -> 8-lane bit table: lane b of entry v holds bit b of v
+struct Ne16WeightUnpackLut {
+  uint8_t lanes[256][8];
+  Ne16WeightUnpackLut() {
+    for(auto v=0; v<256; v++) {
+      for(auto b=0; b<8; b++) {
+        this->lanes[v][b] = (v >> b) & 0x1;
+      }
+    }
   }
-  else
-    return (xt::cast<int32_t>(x) * kappa_bn + lambda_bn + (use_rounding ? 1<<(shift_reqnt-1) : 0)) >> shift_reqnt;
-}
+};
 
+static const Ne16WeightUnpackLut __weight_unpack_lut;
+
+// unpacks size x 16 bits of weights into a (size, 16) array of 0/1 lanes, or
+// (2*size, 16) in mode16 where each byte is replicated in both lane halves
 xt::xarray<uint8_t> __WeightUnpack(
-  xt::xarray<uint8_t> w,
-  int                 size,
-  bool                mode16
+  const xt::xarray<uint8_t>& w,
+  int                        size,
+  bool                       mode16
 ) {
-  w = w.reshape({size,2,1});
-  xt::xarray<uint8_t> wu = xt::zeros<uint8_t>({size,2,8});
-  xt::view(wu, xt::all(), xt::all()) = xt::view(w, xt::all(), xt::all());
-  wu = (wu >> xt::linspace(0, 7, 8).reshape({1, 1, 8})) & 0x1;
-  if(mode16) {
-    return xt::hstack(xt::xtuple(wu.reshape({size*2, 8}), wu.reshape({size*2, 8})));
+  std::vector<size_t> shape = { (size_t) (mode16 ? size*2 : size), 16 };
+  xt::xarray<uint8_t> wu = xt::xarray<uint8_t>::from_shape(shape);
+  const uint8_t *src = w.data();
+  uint8_t *dst = wu.data();
+  for(auto i=0; i<size*2; i++) {
+    const uint8_t *lanes = __weight_unpack_lut.lanes[src[i]];
+    memcpy(dst, lanes, 8);
+    dst += 8;
+    if(mode16) {
+      memcpy(dst, lanes, 8);
+      dst += 8;
+    }
   }
-  return wu.reshape({size, 2*8});
+  return wu;
 }
 
 xt::xarray<int64_t> __BinConvBlock(
@@ -74,30 +74,22 @@ int  Ne16::normquant_mult_cycle() {
   int64_t cycles = 0;
   xt::xarray<uint8_t> nq = this->vld_nq.ex(4, cycles);
   // FIXME casting --> 1) load NQS; 2) load NQ and compute MULT; 3) load NQB and compute shift+bias
-  if(this->normalization_bits == 8) {
-    auto nmult = 4;
-    for(auto i=0; i<nmult; i++) {
-      for(auto col=0; col<this->NR_COLUMN; col++) {
-        xt::view(this->accum, this->nq_iter*nmult+i, col) = xt::view(this->accum, this->nq_iter*nmult+i, col) * xt::view(nq, i);
-      }
+  // each cycle scales 32 bits worth of normalization factors, i.e. 4, 2 or 1 accumulator rows
+  auto nmult = 32 / this->normalization_bits;
+  for(auto i=0; i<nmult; i++) {
+    int64_t mult;
+    if(this->normalization_bits == 8) {
+      mult = nq(i);
     }
-  }
-  else if(this->normalization_bits == 16) {
-    auto nmult = 2;
-    xt::xarray<uint16_t> nq16 = xt::zeros<uint16_t>({2});
-    xt::view(nq16, 0) = xt::view(nq, 0) + (xt::view(nq, 1) << 8);
-    xt::view(nq16, 1) = xt::view(nq, 2) + (xt::view(nq, 3) << 8);
-    for(auto i=0; i<2; i++) {
-      for(auto col=0; col<this->NR_COLUMN; col++) {
-        xt::view(this->accum, this->nq_iter*nmult+i, col) = xt::view(this->accum, this->nq_iter*nmult+i, col) * xt::view(nq16, i);
-      }
+    else if(this->normalization_bits == 16) {
+      mult = (uint16_t) (nq(i*2) | (nq(i*2+1) << 8));
     }
-  }
-  else if(this->normalization_bits == 32) {
-    xt::xarray<uint32_t> nq32 = xt::zeros<uint32_t>({1});
-    xt::view(nq32, 0) = xt::view(nq, 0) + (xt::view(nq, 1) << 8) + (xt::view(nq, 2) << 16) + (xt::view(nq, 3) << 24);
+    else {
+      mult = (uint32_t) nq(0) | ((uint32_t) nq(1) << 8) | ((uint32_t) nq(2) << 16) | ((uint32_t) nq(3) << 24);
+    }
+    int64_t *row = this->accum.data() + (this->nq_iter*nmult+i)*this->NR_COLUMN;
     for(auto col=0; col<this->NR_COLUMN; col++) {
-      xt::view(this->accum, this->nq_iter, col) = xt::view(this->accum, this->nq_iter, col) * xt::view(nq32, 0);
+      row[col] *= mult;
     }
   }
   return (int) cycles;
@@ -142,35 +134,35 @@ void Ne16::normquant_bias_setup() {
 
 int  Ne16::normquant_bias_cycle() {
   int64_t cycles = 0;
-  xt::xarray<int32_t> nqb32 = xt::zeros<int32_t>({8});
+  int32_t nqb32[8] = { 0 };
   if(this->norm_option_bias) {
     xt::xarray<uint8_t> nqb = this->vld_nqb.ex(32, cycles);
     for(auto i=0; i<8; i++) {
-      xt::view(nqb32, i) = xt::cast<int32_t>(xt::view(nqb, i*4) + (xt::view(nqb, i*4+1) << 8) + (xt::view(nqb, i*4+2) << 16) + (xt::view(nqb, i*4+3) << 24));
-    }
-    for(auto col=0; col<this->NR_COLUMN; col++) {
-      xt::view(this->accum, xt::range(this->nqb_iter*8, (this->nqb_iter+1)*8), col) = (xt::view(this->accum, xt::range(this->nqb_iter*8, (this->nqb_iter+1)*8), col) + nqb32);
+      nqb32[i] = (int32_t) ((uint32_t) nqb(i*4) | ((uint32_t) nqb(i*4+1) << 8) | ((uint32_t) nqb(i*4+2) << 16) | ((uint32_t) nqb(i*4+3) << 24));
     }
-    if(this->norm_option_shift) {
+  }
+
+  // bias, shift and output clipping are fused in a single sweep over the 8 rows of this cycle
+  int64_t clip_min, clip_max;
+  bool use_clip = this->streamout_clip_bounds(clip_min, clip_max);
+  for(auto i=0; i<8; i++) {
+    auto k = this->nqb_iter*8+i;
+    int shift = this->norm_option_shift ? this->nqs(k) : this->quantization_right_shift;
+    int64_t *row = this->accum.data() + k*this->NR_COLUMN;
+    if(this->norm_option_bias) {
+      // with bias, the shift is done on the 32-bit datapath value
       for(auto col=0; col<this->NR_COLUMN; col++) {
-        xt::view(this->accum, xt::range(this->nqb_iter*8, (this->nqb_iter+1)*8), col) = xt::cast<int32_t>(xt::view(this->accum, xt::range(this->nqb_iter*8, (this->nqb_iter+1)*8), col)) >> xt::view(this->nqs, xt::range(this->nqb_iter*8, (this->nqb_iter+1)*8));
+        row[col] = (int32_t) (row[col] + nqb32[i]) >> shift;
       }
     }
     else {
       for(auto col=0; col<this->NR_COLUMN; col++) {
-        xt::view(this->accum, xt::range(this->nqb_iter*8, (this->nqb_iter+1)*8), col) = xt::cast<int32_t>(xt::view(this->accum, xt::range(this->nqb_iter*8, (this->nqb_iter+1)*8), col)) >> this->quantization_right_shift;
+        row[col] = row[col] >> shift;
       }
     }
-  }
-  else {
-    if(this->norm_option_shift) {
-      for(auto col=0; col<this->NR_COLUMN; col++) {
-        xt::view(this->accum, xt::range(this->nqb_iter*8, (this->nqb_iter+1)*8), col) = (xt::view(this->accum, xt::range(this->nqb_iter*8, (this->nqb_iter+1)*8), col)) >> xt::view(this->nqs, xt::range(this->nqb_iter*8, (this->nqb_iter+1)*8));
-      }
-    }
-    else {
+    if(use_clip) {
       for(auto col=0; col<this->NR_COLUMN; col++) {
-        xt::view(this->accum, xt::range(this->nqb_iter*8, (this->nqb_iter+1)*8), col) = (xt::view(this->accum, xt::range(this->nqb_iter*8, (this->nqb_iter+1)*8), col)) >> this->quantization_right_shift;
+        row[col] = std::min(std::max(row[col], clip_min), clip_max);
       }
     }
   }
@@ -0,0 +1,73 @@
+/*
+ * Copyright (C) 2020  GreenWaves Technologies, SAS
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/* 
+ * Authors: Francesco Conti, University of Bologna & GreenWaves Technologies (f.conti@unibo.it)
+ */
+
+#include <ne16.hpp>
+
+static const char *ne16_state_names[NE16_NB_STATES] = {
+  "IDLE", "START", "START_STREAMIN", "STREAMIN_LOAD", "LOAD_MATRIXVEC", "STREAMIN", "LOAD",
+  "MATRIXVEC", "NORMQUANT_SHIFT", "NORMQUANT_MULT", "NORMQUANT_BIAS", "STREAMOUT", "END"
+};
+
+void Ne16::perf_setup() {
+  for(auto i=0; i<NE16_NB_STATES; i++) {
+    this->traces.new_trace_event(std::string("perf/") + ne16_state_names[i], &this->perf_state_events[i], 32);
+  }
+  this->traces.new_trace_event("perf/job_cycles", &this->perf_job_cycles_event, 32);
+  this->traces.new_trace_event("perf/load_latency", &this->perf_load_latency_event, 32);
+  this->traces.new_trace_event("perf/store_latency", &this->perf_store_latency_event, 32);
+}
+
+void Ne16::perf_clear() {
+  for(auto i=0; i<NE16_NB_STATES; i++) {
+    this->perf_state_cycles[i] = 0;
+  }
+  this->perf_load_latency = 0;
+  this->perf_store_latency = 0;
+  this->perf_job_start = this->clock.get_cycles();
+}
+
+// Dumps the counters of the job which just ended, both as trace events and
+// as a single summary line
+void Ne16::perf_report(int job_id) {
+  uint32_t value;
+  std::ostringstream stringStream;
+
+  int64_t job_cycles = this->clock.get_cycles() - this->perf_job_start;
+  value = job_cycles;
+  this->perf_job_cycles_event.event((uint8_t *)&value);
+  stringStream << "Job " << job_id << " cycles: total=" << job_cycles;
+
+  for(int i=START; i<NE16_NB_STATES; i++) {
+    value = this->perf_state_cycles[i];
+    this->perf_state_events[i].event((uint8_t *)&value);
+    if(this->perf_state_cycles[i] != 0) {
+      stringStream << " " << ne16_state_names[i] << "=" << this->perf_state_cycles[i];
+    }
+  }
+
+  value = this->perf_load_latency;
+  this->perf_load_latency_event.event((uint8_t *)&value);
+  value = this->perf_store_latency;
+  this->perf_store_latency_event.event((uint8_t *)&value);
+  stringStream << " load_latency=" << this->perf_load_latency << " store_latency=" << this->perf_store_latency << "\n";
+
+  std::string copyOfStr = stringStream.str();
+  this->trace.msg(vp::Trace::LEVEL_INFO, copyOfStr.c_str());
+}
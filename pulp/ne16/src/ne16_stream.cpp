@@ -214,6 +214,7 @@ xt::xarray<T> Ne16VectorLoad<T>::ex(int width, int64_t& cycles) {
   if (this->ne16->trace_level == L3_ALL) {
     this->ne16->trace.msg(vp::Trace::LEVEL_DEBUG, s.c_str());
   }
+  this->ne16->perf_load_latency += max_latency;
   cycles += max_latency + 1;
   return x;
 }
@@ -288,6 +289,7 @@ xt::xarray<T> Ne16VectorStore<T>::ex(xt::xarray<T> data, int width, int64_t& cyc
       this->ne16->trace.msg(vp::Trace::LEVEL_DEBUG, s.c_str());
     }
   }
+  this->ne16->perf_store_latency += max_latency;
   cycles += max_latency + 1;
   return data;
 }
@@ -67,18 +67,14 @@ void Ne16::streamout_setup() {
   this->streamout_i_out_iter = 0;
   this->streamout_j_out_iter = 0;
 
-  // relu is here because of easier modeling
-  if(this->quantization_bits == 8) {
-    if(this->use_relu) {
-      xt::view(this->accum, xt::all()) = xt::clip(this->accum, 0, 255);
-    }
-    else {
-      xt::view(this->accum, xt::all()) = xt::clip(this->accum, -128, 127);
+  // relu is here because of easier modeling, with output quantization it is already fused in NORMQUANT_BIAS
+  int64_t clip_min, clip_max;
+  if(!this->output_quant && this->streamout_clip_bounds(clip_min, clip_max)) {
+    int64_t *accum = this->accum.data();
+    for(size_t i=0; i<this->accum.size(); i++) {
+      accum[i] = std::min(std::max(accum[i], clip_min), clip_max);
     }
   }
-  else if(this->use_relu && this->output_quant) {
-    xt::view(this->accum, xt::all()) = xt::clip(this->accum, 0, 0xffffffff);
-  }
   if(this->accum_traces) {
     this->debug_accum();
   }
@@ -95,6 +91,20 @@ void Ne16::streamout_setup() {
   }
 }
 
+bool Ne16::streamout_clip_bounds(int64_t& clip_min, int64_t& clip_max) {
+  if(this->quantization_bits == 8) {
+    clip_min = this->use_relu ? 0 : -128;
+    clip_max = this->use_relu ? 255 : 127;
+    return true;
+  }
+  else if(this->use_relu && this->output_quant) {
+    clip_min = 0;
+    clip_max = 0xffffffff;
+    return true;
+  }
+  return false;
+}
+
 int Ne16::streamout_cycle() { 
   int64_t cycles = 0;
   auto tp = this->depthwise ? this->TP_IN : this->TP_OUT;
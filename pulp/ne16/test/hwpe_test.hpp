@@ -0,0 +1,790 @@
+/*
+ * Copyright (C) 2024 ETH Zurich and University of Bologna
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * Regression harness shared by the NE16 and Neureka tests.
+ * The accelerator model is instantiated on top of the runtime stub (stub/vp), with its master
+ * ports bound to flat memories and its slave port driven like a core would do: acquire a
+ * context, write the registers, commit, and wait for the end-of-job interrupt.
+ * The layer is packed into memory following the documented layouts, and the output buffer is
+ * compared byte by byte with a plain integer convolution followed by the requantization,
+ * whose clipping range only depends on the output width and signedness.
+ */
+
+#ifndef __HWPE_TEST_HPP__
+#define __HWPE_TEST_HPP__
+
+#include <vp/vp.hpp>
+#include <vp/itf/io.hpp>
+#include <vp/itf/wire.hpp>
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <algorithm>
+#include <chrono>
+#include <stdexcept>
+#include <vector>
+
+
+extern "C" vp::Component *gv_new(vp::ComponentConf &config);
+
+
+#define HWPE_REG_WEIGHTS_PTR       0
+#define HWPE_REG_INFEAT_PTR        1
+#define HWPE_REG_OUTFEAT_PTR       2
+#define HWPE_REG_SCALE_PTR         3
+#define HWPE_REG_SCALE_SHIFT_PTR   4
+#define HWPE_REG_SCALE_BIAS_PTR    5
+#define HWPE_REG_INFEAT_D0_STRIDE  6
+#define HWPE_REG_INFEAT_D1_STRIDE  7
+#define HWPE_REG_INFEAT_D2_STRIDE  8
+#define HWPE_REG_OUTFEAT_D0_STRIDE 9
+#define HWPE_REG_OUTFEAT_D1_STRIDE 10
+#define HWPE_REG_OUTFEAT_D2_STRIDE 11
+#define HWPE_REG_WEIGHTS_D0_STRIDE 12
+#define HWPE_REG_WEIGHTS_D1_STRIDE 13
+#define HWPE_REG_WEIGHTS_D2_STRIDE 14
+#define HWPE_REG_SUBTILE_REM0      15
+#define HWPE_REG_SUBTILE_REM1      16
+#define HWPE_REG_SUBTILE_REM2      17
+#define HWPE_REG_SUBTILE_NB0       18
+#define HWPE_REG_SUBTILE_NB1       19
+#define HWPE_REG_PADDING           20
+#define HWPE_REG_WEIGHT_OFFSET     21
+#define HWPE_REG_FILTER_MASK       22
+#define HWPE_REG_CONFIG0           23
+#define HWPE_NB_REG                24
+
+// Written to the output buffer before the job, to catch stores outside of the output pixels
+#define HWPE_SENTINEL 0xa5
+
+
+// Flat memory behind an IO slave, addresses wrap around its size, which must be a power of 2
+class Memory : public vp::Component
+{
+public:
+    Memory(vp::ComponentConf &config, size_t size) : vp::Component(config), data(size, 0)
+    {
+        this->input.set_req_meth(&Memory::req);
+        this->new_slave_port("input", &this->input);
+    }
+
+    void write(uint32_t addr, const std::vector<uint8_t> &bytes)
+    {
+        for (size_t i=0; i<bytes.size(); i++)
+        {
+            this->data[(addr + i) & (this->data.size() - 1)] = bytes[i];
+        }
+    }
+
+    std::vector<uint8_t> read(uint32_t addr, size_t size)
+    {
+        std::vector<uint8_t> bytes(size);
+        for (size_t i=0; i<size; i++)
+        {
+            bytes[i] = this->data[(addr + i) & (this->data.size() - 1)];
+        }
+        return bytes;
+    }
+
+    vp::IoSlave input;
+
+private:
+    static vp::IoReqStatus req(vp::Block *__this, vp::IoReq *req)
+    {
+        Memory *_this = (Memory *)__this;
+        for (uint64_t i=0; i<req->get_size(); i++)
+        {
+            uint8_t &byte = _this->data[(req->get_addr() + i) & (_this->data.size() - 1)];
+            if (req->get_is_write())
+            {
+                byte = req->get_data()[i];
+            }
+            else
+            {
+                req->get_data()[i] = byte;
+            }
+        }
+        return vp::IO_REQ_OK;
+    }
+
+    std::vector<uint8_t> data;
+};
+
+
+// Core side of the accelerator, accesses its registers and counts its end-of-job interrupts
+class Host : public vp::Component
+{
+public:
+    Host(vp::ComponentConf &config) : vp::Component(config)
+    {
+        this->irq.set_sync_meth(&Host::irq_sync);
+        this->new_master_port("cfg", &this->cfg);
+        this->new_slave_port("irq", &this->irq);
+    }
+
+    uint32_t access(uint32_t offset, uint32_t value, bool is_write)
+    {
+        vp::IoReq req;
+        req.init();
+        req.set_addr(offset);
+        req.set_size(4);
+        req.set_data((uint8_t *)&value);
+        req.set_is_write(is_write);
+        if (this->cfg.req(&req) != vp::IO_REQ_OK)
+        {
+            throw std::runtime_error("Register access failed");
+        }
+        return value;
+    }
+
+    vp::IoMaster cfg;
+    vp::WireSlave<bool> irq;
+    int nb_irqs = 0;
+
+private:
+    static void irq_sync(vp::Block *__this, bool value)
+    {
+        if (value)
+        {
+            ((Host *)__this)->nb_irqs++;
+        }
+    }
+};
+
+
+// One accelerator instance with its memories, L1 behind "out" and the weight memory behind
+// "wmem_out" when the model has one
+class Harness
+{
+public:
+    Harness(int nb_jobs, bool job_preload, size_t mem_size)
+    {
+        this->acc_config.set("nb_jobs", nb_jobs);
+        this->acc_config.set("job_preload", job_preload);
+        vp::ComponentConf acc_conf = { &this->acc_config, &this->clock };
+        vp::ComponentConf conf = { &this->config, &this->clock };
+
+        this->l1 = new Memory(conf, mem_size);
+        this->wmem = new Memory(conf, mem_size);
+        this->host = new Host(conf);
+        this->acc = gv_new(acc_conf);
+
+        ((vp::IoMaster *)this->acc->get_port("out"))->bind_to(&this->l1->input);
+        vp::IoMaster *wmem_out = (vp::IoMaster *)this->acc->get_port("wmem_out");
+        if (wmem_out)
+        {
+            wmem_out->bind_to(&this->wmem->input);
+        }
+        ((vp::WireMaster<bool> *)this->acc->get_port("irq"))->bind_to(&this->host->irq);
+        this->host->cfg.bind_to((vp::IoSlave *)this->acc->get_port("input"));
+
+        this->acc->reset(true);
+        this->acc->reset(false);
+    }
+
+    ~Harness()
+    {
+        delete this->acc;
+        delete this->host;
+        delete this->wmem;
+        delete this->l1;
+    }
+
+    // Queues a job, waiting for a context to be released when they are all busy
+    int offload(const std::vector<uint32_t> &regs)
+    {
+        int job_id;
+        while ((job_id = (int)this->host->access(0x4, 0, false)) < 0)
+        {
+            this->step();
+        }
+        for (int i=0; i<HWPE_NB_REG; i++)
+        {
+            this->host->access(0x20 + i*4, regs[i], true);
+        }
+        this->host->access(0x0, 0, true);
+        this->nb_jobs++;
+        return job_id;
+    }
+
+    // Runs until all the queued jobs have raised their interrupt
+    void wait()
+    {
+        while (this->host->nb_irqs < this->nb_jobs)
+        {
+            this->step();
+        }
+        if (this->host->access(0xc, 0, false) != 0)
+        {
+            throw std::runtime_error("Contexts still busy after the last interrupt");
+        }
+    }
+
+    // Simple bump allocator, the accelerator only needs word-aligned buffers
+    uint32_t alloc(size_t size)
+    {
+        uint32_t addr = this->alloc_ptr;
+        this->alloc_ptr = (this->alloc_ptr + size + 3) & ~3;
+        return addr;
+    }
+
+    Memory *l1;
+    Memory *wmem;
+
+private:
+    void step()
+    {
+        if (!this->clock.step())
+        {
+            throw std::runtime_error("Accelerator stalled with pending jobs");
+        }
+    }
+
+    vp::ClockEngine clock;
+    js::Config config;
+    js::Config acc_config;
+    Host *host;
+    vp::Component *acc;
+    int nb_jobs = 0;
+    // Leaves room for the input pointer moved back by the padding
+    uint32_t alloc_ptr = 0x400;
+};
+
+
+// Deterministic generator, so that failing layers can be replayed from their seed
+class Rng
+{
+public:
+    Rng(uint64_t seed) : state(seed * 0x9e3779b97f4a7c15ULL + 1) {}
+
+    uint32_t next()
+    {
+        this->state ^= this->state >> 12;
+        this->state ^= this->state << 25;
+        this->state ^= this->state >> 27;
+        return (this->state * 0x2545f4914f6cdd1dULL) >> 32;
+    }
+
+    // Uniform in [min, max]
+    int64_t range(int64_t min, int64_t max)
+    {
+        uint64_t r = ((uint64_t)this->next() << 32) | this->next();
+        return min + (int64_t)(r % (uint64_t)(max - min + 1));
+    }
+
+    bool flip() { return this->next() & 1; }
+
+private:
+    uint64_t state;
+};
+
+
+struct Layer
+{
+    Layer() {}
+    Layer(const char *name, int fs, int k_in, int k_out, int h_out, int w_out)
+        : name(name), fs(fs), k_in(k_in), k_out(k_out), h_out(h_out), w_out(w_out) {}
+
+    std::string name;
+    int fs = 3;
+    bool depthwise = false;
+    bool linear = false;
+    // Strided 2x2, dispatched as one job per 2x2 block of outputs
+    bool strided = false;
+    // 16-bit activations, k_in counts 16-bit channels
+    bool mode16 = false;
+    int k_in = 16;
+    int k_out = 32;
+    int h_out = 3;
+    int w_out = 3;
+    int qw = 8;
+    int pad_top = 0;
+    int pad_right = 0;
+    int pad_bottom = 0;
+    int pad_left = 0;
+    int pad_value = 0;
+    // Disabled filter taps, bit fy*3+fx
+    int filter_mask = 0;
+    int out_bits = 8;
+    bool quant = true;
+    bool relu = true;
+    bool bias = false;
+    bool shift = false;
+    int norm_bits = 8;
+    bool signed_act = false;
+    // Weights fetched from the weight memory instead of L1
+    bool wmem = false;
+    int nb_jobs = 1;
+    bool preload = false;
+
+    int stride() const { return this->strided ? 2 : 1; }
+    int h_in() const { return (this->h_out - 1) * this->stride() + this->fs - this->pad_top - this->pad_bottom; }
+    int w_in() const { return (this->w_out - 1) * this->stride() + this->fs - this->pad_left - this->pad_right; }
+    int nb_taps() const { return this->fs * this->fs; }
+    int64_t nb_macs() const
+    {
+        return (int64_t)this->h_out * this->w_out * this->k_out * this->nb_taps() * (this->depthwise ? 1 : this->k_in);
+    }
+};
+
+
+// Accelerator specific part: tiling, weight layout and configuration bits
+struct Arch
+{
+    const char *name;
+    size_t l1_size;
+    int tile;                   // output pixels per tile side
+    int tp_in_3x3;              // input channels per tile, in bytes
+    int tp_in_1x1;
+    int tp_dw;                  // channels per depthwise tile
+    int tp_out;
+    std::vector<uint8_t> (*pack_weights)(const Layer &layer, const std::vector<int> &weights);
+    void (*weight_strides)(const Layer &layer, uint32_t *regs);
+    uint32_t (*filter_mask)(int mask);
+    uint32_t (*config_bits)(const Layer &layer);
+};
+
+
+static inline int div_up(int a, int b) { return (a + b - 1) / b; }
+static inline int rem_up(int a, int b) { return (a - 1) % b + 1; }
+
+
+// Range of the outputs, from their width and signedness. Rectified outputs stay signed when
+// the activations are.
+static inline void clip_bounds(int bits, bool relu, bool is_signed, int64_t &min, int64_t &max)
+{
+    is_signed = is_signed || !relu;
+    min = relu ? 0 : -(1LL << (bits - 1));
+    max = is_signed ? (1LL << (bits - 1)) - 1 : (1LL << bits) - 1;
+}
+
+
+// Integer convolution on HWC activations, padding included, and [k_out][fy][fx][k_in]
+// weights ([k][fy][fx] for depthwise), returns [h_out][w_out][k_out] accumulators
+static std::vector<int64_t> conv_reference(const Layer &l, const std::vector<int> &x, const std::vector<int> &w)
+{
+    int h_in = l.h_in(), w_in = l.w_in();
+    std::vector<int64_t> acc(l.h_out * l.w_out * l.k_out, 0);
+    for (int oy=0; oy<l.h_out; oy++)
+    {
+        for (int ox=0; ox<l.w_out; ox++)
+        {
+            for (int ko=0; ko<l.k_out; ko++)
+            {
+                int64_t sum = 0;
+                for (int fy=0; fy<l.fs; fy++)
+                {
+                    for (int fx=0; fx<l.fs; fx++)
+                    {
+                        if ((l.filter_mask >> (fy*3 + fx)) & 1)
+                        {
+                            continue;
+                        }
+                        int iy = oy * l.stride() + fy - l.pad_top;
+                        int ix = ox * l.stride() + fx - l.pad_left;
+                        bool pad = iy < 0 || iy >= h_in || ix < 0 || ix >= w_in;
+                        for (int ki=0; ki<l.k_in; ki++)
+                        {
+                            if (l.depthwise && ki != ko)
+                            {
+                                continue;
+                            }
+                            int xv = pad ? l.pad_value : x[(iy*w_in + ix)*l.k_in + ki];
+                            int wv = l.depthwise ? w[(ko*l.fs + fy)*l.fs + fx] : w[((ko*l.fs + fy)*l.fs + fx)*l.k_in + ki];
+                            sum += (int64_t)xv * wv;
+                        }
+                    }
+                }
+                acc[(oy*l.w_out + ox)*l.k_out + ko] = sum;
+            }
+        }
+    }
+    return acc;
+}
+
+
+struct Quant
+{
+    std::vector<int64_t> scale;
+    std::vector<int32_t> bias;
+    std::vector<int> shift;
+    int right_shift = 0;
+};
+
+
+// Scales, biases and shifts which keep the scaled accumulators within 31 bits, with shifts
+// around the ones bringing the largest output to the output width, so that both clipping
+// bounds are hit
+static Quant quant_params(const Layer &l, const std::vector<int64_t> &acc, Rng &rng)
+{
+    int64_t max_abs = 1;
+    for (int64_t v : acc)
+    {
+        max_abs = std::max(max_abs, v < 0 ? -v : v);
+    }
+    if (max_abs >= (1LL << 30))
+    {
+        throw std::runtime_error("Layer too large for 32-bit accumulators");
+    }
+    int64_t scale_max = std::min((1LL << l.norm_bits) - 1, (1LL << 30) / max_abs);
+    int64_t scaled_max = max_abs * scale_max;
+    int base_shift = 0;
+    while ((scaled_max >> base_shift) >= (1LL << (l.out_bits - 1)))
+    {
+        base_shift++;
+    }
+    base_shift = std::min(base_shift, 31);
+
+    Quant q;
+    q.right_shift = base_shift;
+    for (int k=0; k<l.k_out; k++)
+    {
+        q.scale.push_back(rng.range(1, scale_max));
+        q.bias.push_back(l.bias ? rng.range(-scaled_max/4, scaled_max/4) : 0);
+        q.shift.push_back(l.shift ? rng.range(std::max(base_shift - 2, 0), std::min(base_shift + 1, 31)) : base_shift);
+    }
+    return q;
+}
+
+
+static int64_t requant(const Layer &l, const Quant &q, int64_t acc, int k)
+{
+    if (!l.quant)
+    {
+        return acc;
+    }
+    int64_t min, max;
+    clip_bounds(l.out_bits, l.relu, l.signed_act, min, max);
+    int64_t value = (acc * q.scale[k] + q.bias[k]) >> q.shift[k];
+    return std::min(std::max(value, min), max);
+}
+
+
+static std::vector<uint8_t> to_bytes(const std::vector<int64_t> &values, int bytes)
+{
+    std::vector<uint8_t> result;
+    for (int64_t v : values)
+    {
+        for (int i=0; i<bytes; i++)
+        {
+            result.push_back((v >> (i*8)) & 0xff);
+        }
+    }
+    return result;
+}
+
+
+struct Buffers
+{
+    uint32_t weights;
+    uint32_t infeat;
+    uint32_t outfeat;
+    uint32_t scale;
+    uint32_t scale_shift;
+    uint32_t scale_bias;
+};
+
+
+// Registers of a job computing h_out x w_out outputs of the accelerator, at stride 1
+static std::vector<uint32_t> job_regs(const Arch &arch, const Layer &l, const Buffers &b, int right_shift,
+    int h_out, int w_out)
+{
+    std::vector<uint32_t> regs(HWPE_NB_REG, 0);
+    int in_bytes = l.mode16 ? 2 : 1;
+    int out_bytes = l.out_bits / 8;
+    int k_in = l.k_in * in_bytes;
+
+    int tp_in = l.linear ? 256 : l.depthwise ? arch.tp_dw : l.fs == 3 ? arch.tp_in_3x3 : arch.tp_in_1x1;
+    int nb_ki = div_up(k_in, tp_in);
+    int rem_ki = rem_up(k_in, tp_in);
+    if (l.linear)
+    {
+        // the remainder is counted in 16 channels rows
+        rem_ki = div_up(rem_ki, 16);
+    }
+    int tp_out = l.depthwise ? arch.tp_dw : arch.tp_out;
+    int nb_ko = l.depthwise ? nb_ki : div_up(l.k_out, tp_out);
+    int rem_ko = l.depthwise ? rem_ki : rem_up(l.k_out, tp_out);
+    int rem_ho = rem_up(h_out, arch.tile);
+    int rem_wo = rem_up(w_out, arch.tile);
+    // input remainders as pulp-nnx computes them, without the bottom and right padding
+    int rem_hi = (l.fs == 3 ? rem_ho + 2 : rem_ho) - l.pad_bottom;
+    int rem_wi = (l.fs == 3 ? rem_wo + 2 : rem_wo) - l.pad_right;
+
+    regs[HWPE_REG_WEIGHTS_PTR] = b.weights;
+    regs[HWPE_REG_INFEAT_PTR] = b.infeat;
+    regs[HWPE_REG_OUTFEAT_PTR] = b.outfeat;
+    regs[HWPE_REG_SCALE_PTR] = b.scale;
+    regs[HWPE_REG_SCALE_SHIFT_PTR] = b.scale_shift;
+    regs[HWPE_REG_SCALE_BIAS_PTR] = b.scale_bias;
+    regs[HWPE_REG_INFEAT_D0_STRIDE] = l.linear ? 16 : k_in;
+    regs[HWPE_REG_INFEAT_D1_STRIDE] = k_in * l.w_in();
+    regs[HWPE_REG_INFEAT_D2_STRIDE] = 0;
+    regs[HWPE_REG_OUTFEAT_D0_STRIDE] = 32;
+    regs[HWPE_REG_OUTFEAT_D1_STRIDE] = l.k_out * out_bytes;
+    regs[HWPE_REG_OUTFEAT_D2_STRIDE] = l.k_out * out_bytes * l.w_out;
+    arch.weight_strides(l, regs.data());
+    regs[HWPE_REG_SUBTILE_REM0] = (rem_ko << 16) | rem_ki;
+    regs[HWPE_REG_SUBTILE_REM1] = (rem_ho << 16) | rem_wo;
+    regs[HWPE_REG_SUBTILE_REM2] = (rem_hi << 16) | rem_wi;
+    regs[HWPE_REG_SUBTILE_NB0] = (nb_ko << 16) | nb_ki;
+    regs[HWPE_REG_SUBTILE_NB1] = (div_up(h_out, arch.tile) << 16) | div_up(w_out, arch.tile);
+    regs[HWPE_REG_PADDING] = (l.pad_top << 28) | (l.pad_right << 24) | (l.pad_bottom << 20) | (l.pad_left << 16) |
+        (l.pad_value & 0xffff);
+    regs[HWPE_REG_WEIGHT_OFFSET] = (uint32_t)-(1 << (l.qw - 1));
+    regs[HWPE_REG_FILTER_MASK] = arch.filter_mask(l.filter_mask);
+
+    int filter_mode = l.fs == 1 ? 2 : l.depthwise ? 1 : 0;
+    regs[HWPE_REG_CONFIG0] = (l.bias << 25) | (l.shift << 24) | (!l.relu << 23) | ((l.out_bits == 32 ? 2 : 0) << 21) |
+        (right_shift << 16) | ((l.norm_bits == 32 ? 2 : l.norm_bits == 16 ? 1 : 0) << 12) |
+        (l.strided << 8) | (l.linear << 7) | (filter_mode << 5) | (l.quant << 4) | (l.mode16 << 3) | (l.qw - 1) |
+        arch.config_bits(l);
+    return regs;
+}
+
+
+// Runs the layer on the accelerator and checks the whole output buffer, returns true if it
+// matches. The host time spent in the model is accumulated into sim_time.
+static bool run_layer(const Arch &arch, const Layer &l, uint64_t seed, double &sim_time)
+{
+    Rng rng(seed);
+    Harness harness(l.nb_jobs, l.preload, arch.l1_size);
+    int h_in = l.h_in(), w_in = l.w_in();
+    int in_bytes = l.mode16 ? 2 : 1;
+    int out_bytes = l.out_bits / 8;
+
+    // Activations, and weights as unsigned codes on qw bits, offset by Wmin
+    std::vector<int> x(h_in * w_in * l.k_in);
+    for (int &v : x)
+    {
+        v = l.mode16 ? rng.range(0, 0xffff) : l.signed_act ? rng.range(-128, 127) : rng.range(0, 255);
+    }
+    int wmin = -(1 << (l.qw - 1));
+    std::vector<int> codes(l.k_out * l.nb_taps() * (l.depthwise ? 1 : l.k_in));
+    std::vector<int> weights(codes.size());
+    for (size_t i=0; i<codes.size(); i++)
+    {
+        codes[i] = rng.range(0, (1 << l.qw) - 1);
+        weights[i] = codes[i] + wmin;
+    }
+
+    std::vector<int64_t> acc = conv_reference(l, x, weights);
+    Quant q;
+    if (l.quant)
+    {
+        q = quant_params(l, acc, rng);
+    }
+    std::vector<int64_t> expected_values(acc.size());
+    for (size_t i=0; i<acc.size(); i++)
+    {
+        expected_values[i] = requant(l, q, acc[i], i % l.k_out);
+    }
+
+    std::vector<int64_t> x_values(x.begin(), x.end());
+    std::vector<uint8_t> x_bytes = to_bytes(x_values, in_bytes);
+    std::vector<uint8_t> w_bytes = arch.pack_weights(l, codes);
+    std::vector<uint8_t> scale_bytes = to_bytes(q.scale, l.norm_bits / 8);
+    std::vector<int64_t> shift_values(q.shift.begin(), q.shift.end());
+    std::vector<uint8_t> shift_bytes = to_bytes(shift_values, 1);
+    std::vector<int64_t> bias_values(q.bias.begin(), q.bias.end());
+    std::vector<uint8_t> bias_bytes = to_bytes(bias_values, 4);
+    size_t y_size = l.h_out * l.w_out * l.k_out * out_bytes;
+    // the normalization parameters are always fetched by full tiles
+    size_t nq_size = (l.k_out + arch.tp_out) * 4;
+
+    uint32_t x_addr = harness.alloc(x_bytes.size());
+    uint32_t w_addr = harness.alloc(w_bytes.size());
+    uint32_t scale_addr = harness.alloc(nq_size);
+    uint32_t shift_addr = harness.alloc(nq_size);
+    uint32_t bias_addr = harness.alloc(nq_size);
+    uint32_t y_addr = harness.alloc(y_size + 64);
+    if (harness.alloc(0) > arch.l1_size)
+    {
+        throw std::runtime_error("Layer does not fit in L1");
+    }
+
+    harness.l1->write(x_addr, x_bytes);
+    (l.wmem ? harness.wmem : harness.l1)->write(w_addr, w_bytes);
+    harness.l1->write(scale_addr, scale_bytes);
+    harness.l1->write(shift_addr, shift_bytes);
+    harness.l1->write(bias_addr, bias_bytes);
+    harness.l1->write(y_addr, std::vector<uint8_t>(y_size + 64, HWPE_SENTINEL));
+
+    Buffers b = { w_addr, x_addr, y_addr, scale_addr, shift_addr, bias_addr };
+
+    uint32_t pix_in = l.k_in * in_bytes, row_in = pix_in * w_in;
+    uint32_t pix_out = l.k_out * out_bytes, row_out = pix_out * l.w_out;
+
+    auto start = std::chrono::steady_clock::now();
+    if (!l.strided)
+    {
+        b.infeat = x_addr - l.pad_top * row_in - l.pad_left * pix_in;
+        harness.offload(job_regs(arch, l, b, q.right_shift, l.h_out, l.w_out));
+    }
+    else
+    {
+        // Each job computes a 3x3 tile of stride 1 outputs, of which only the corners are
+        // stored, the output strides are halved to store them next to each other
+        for (int by=0; by<l.h_out; by+=2)
+        {
+            for (int bx=0; bx<l.w_out; bx+=2)
+            {
+                b.infeat = x_addr + 2*by * row_in + 2*bx * pix_in;
+                b.outfeat = y_addr + by * row_out + bx * pix_out;
+                int h_out = by + 1 < l.h_out ? 3 : 1;
+                int w_out = bx + 1 < l.w_out ? 3 : 1;
+                std::vector<uint32_t> regs = job_regs(arch, l, b, q.right_shift, h_out, w_out);
+                regs[HWPE_REG_OUTFEAT_D1_STRIDE] = pix_out / 2;
+                regs[HWPE_REG_OUTFEAT_D2_STRIDE] = row_out / 2;
+                harness.offload(regs);
+            }
+        }
+    }
+    harness.wait();
+    sim_time += std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+
+    std::vector<uint8_t> expected = to_bytes(expected_values, out_bytes);
+    expected.resize(y_size + 64, HWPE_SENTINEL);
+    std::vector<uint8_t> result = harness.l1->read(y_addr, y_size + 64);
+    for (size_t i=0; i<expected.size(); i++)
+    {
+        if (expected[i] != result[i])
+        {
+            int pixel = i / pix_out;
+            printf("%s: mismatch at byte %d (oy: %d, ox: %d, k_out: %d, expected: 0x%02x, got: 0x%02x)\n",
+                l.name.c_str(), (int)i, pixel / l.w_out, pixel % l.w_out, (int)(i % pix_out) / out_bytes,
+                expected[i], result[i]);
+            return false;
+        }
+    }
+    return true;
+}
+
+
+// Random layer within the constraints shared by the accelerators, flags gate the modes which
+// are specific to one of them
+static Layer random_layer(const Arch &arch, Rng &rng, bool has_linear, bool has_mode16, bool has_signed)
+{
+    Layer l;
+    int mode = rng.range(0, has_linear ? 3 : 2);
+    l.fs = mode == 2 || mode == 3 ? 1 : 3;
+    l.depthwise = mode == 1;
+    l.linear = mode == 3;
+    l.mode16 = has_mode16 && !l.depthwise && !l.linear && rng.range(0, 3) == 0;
+    l.qw = rng.range(1, 8);
+    l.k_in = l.mode16 ? rng.range(1, 12) : rng.range(1, 2 * arch.tp_in_3x3 + 8);
+    l.k_out = l.depthwise ? l.k_in : rng.range(1, arch.tp_out + 12);
+    l.h_out = rng.range(1, 2 * arch.tile + 1);
+    l.w_out = rng.range(1, 2 * arch.tile + 1);
+    l.out_bits = rng.flip() ? 8 : 32;
+    l.quant = l.out_bits == 8 || rng.flip();
+    l.relu = rng.flip();
+    l.bias = rng.flip();
+    l.shift = rng.flip();
+    l.norm_bits = 8 << rng.range(0, 2);
+    l.signed_act = has_signed && !l.mode16 && rng.flip();
+    l.nb_jobs = rng.range(1, 4);
+    l.preload = rng.flip();
+
+    if (l.linear)
+    {
+        l.k_in = 16 * rng.range(1, 40);
+        l.h_out = l.w_out = 1;
+    }
+    else if (l.fs == 3)
+    {
+        int extra = rng.range(0, 3);
+        if (extra == 1)
+        {
+            l.strided = true;
+            l.h_out = rng.range(1, 5);
+            l.w_out = rng.range(1, 5);
+            if (l.out_bits == 8)
+            {
+                l.k_out += l.k_out & 1;
+            }
+            if (l.depthwise)
+            {
+                l.k_in = l.k_out;
+            }
+        }
+        else if (extra == 2)
+        {
+            l.pad_top = rng.range(0, 1);
+            l.pad_left = rng.range(0, 1);
+            l.pad_bottom = rng.range(0, 1);
+            l.pad_right = rng.range(0, 1);
+            // the bottom and right padding are implicit, so only zero padding is
+            // supported when they are used
+            if (l.pad_bottom == 0 && l.pad_right == 0)
+            {
+                l.pad_value = l.mode16 ? rng.range(0, 0xffff) : l.signed_act ? rng.range(-128, 127) : rng.range(0, 255);
+            }
+        }
+        else if (extra == 3)
+        {
+            l.filter_mask = rng.range(0, 0x1ff);
+        }
+    }
+    l.name = std::string(arch.name) + " random";
+    return l;
+}
+
+
+// Runs the directed layers, then nb_random random ones, and reports the host time per MAC
+static int run_tests(const Arch &arch, const std::vector<Layer> &layers, int nb_random, uint64_t seed,
+    Layer (*random)(const Arch &arch, Rng &rng))
+{
+    int failed = 0;
+    int64_t nb_macs = 0;
+    double sim_time = 0;
+    Rng rng(seed);
+
+    for (int i=0; i<(int)layers.size() + nb_random; i++)
+    {
+        Layer l = i < (int)layers.size() ? layers[i] : random(arch, rng);
+        uint64_t layer_seed = seed * 1000 + i;
+        bool ok = false;
+        try
+        {
+            ok = run_layer(arch, l, layer_seed, sim_time);
+        }
+        catch (std::exception &e)
+        {
+            printf("%s: %s\n", l.name.c_str(), e.what());
+        }
+        if (!ok)
+        {
+            printf("FAILED %s #%d (seed: %lu, fs: %d, depthwise: %d, linear: %d, strided: %d, mode16: %d, "
+                "k_in: %d, k_out: %d, h_out: %d, w_out: %d, qw: %d, padding: %d/%d/%d/%d value %d, mask: 0x%x, "
+                "out_bits: %d, quant: %d, relu: %d, bias: %d, shift: %d, norm_bits: %d, signed: %d, wmem: %d, "
+                "nb_jobs: %d, preload: %d)\n",
+                l.name.c_str(), i, (unsigned long)layer_seed, l.fs, l.depthwise, l.linear, l.strided, l.mode16,
+                l.k_in, l.k_out, l.h_out, l.w_out, l.qw, l.pad_top, l.pad_right, l.pad_bottom, l.pad_left,
+                l.pad_value, l.filter_mask, l.out_bits, l.quant, l.relu, l.bias, l.shift, l.norm_bits,
+                l.signed_act, l.wmem, l.nb_jobs, l.preload);
+            failed++;
+        }
+        nb_macs += l.nb_macs();
+    }
+
+    printf("%s: %d layers, %d failed\n", arch.name, (int)layers.size() + nb_random, failed);
+    printf("%s: host time per MAC: %.2f ns\n", arch.name, nb_macs ? sim_time / nb_macs : 0.0);
+    return failed ? 1 : 0;
+}
+
+#endif
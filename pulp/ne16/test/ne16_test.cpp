@@ -0,0 +1,264 @@
+/*
+ * Copyright (C) 2024 ETH Zurich and University of Bologna
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * NE16 regression test, usage: ne16_test [nb_random_layers] [seed]
+ */
+
+#include "hwpe_test.hpp"
+
+
+// Weights are stored bit plane by bit plane, 1 bit per input channel. In 8-bit mode a plane
+// covers 16 channels on 2 bytes, in 16-bit mode 8 channels on 1 byte.
+static std::vector<uint8_t> ne16_pack_weights(const Layer &l, const std::vector<int> &codes)
+{
+    if (l.linear)
+    {
+        // [k_out][qw][k_in / 8]
+        int row = l.k_in / 8;
+        std::vector<uint8_t> bytes(l.k_out * l.qw * row, 0);
+        for (int ko=0; ko<l.k_out; ko++)
+        {
+            for (int ki=0; ki<l.k_in; ki++)
+            {
+                int code = codes[ko*l.k_in + ki];
+                for (int bit=0; bit<l.qw; bit++)
+                {
+                    bytes[(ko*l.qw + bit)*row + ki/8] |= ((code >> bit) & 1) << (ki % 8);
+                }
+            }
+        }
+        return bytes;
+    }
+
+    int tp = l.mode16 ? 8 : 16;
+    int plane = tp / 8;
+    int nb_rows = l.nb_taps();
+    int nb_ki = div_up(l.depthwise ? l.k_out : l.k_in, tp);
+    int nb_ko = l.depthwise ? 1 : l.k_out;
+    std::vector<uint8_t> bytes(nb_ko * nb_ki * l.qw * nb_rows * plane, 0);
+
+    // [k_out][k_in / tp][qw][fs*fs][plane], without the k_out dimension for depthwise
+    for (int ko=0; ko<l.k_out; ko++)
+    {
+        for (int ki=0; ki<(l.depthwise ? 1 : l.k_in); ki++)
+        {
+            int ch = l.depthwise ? ko : ki;
+            int kim = ch / tp, c = ch % tp;
+            for (int r=0; r<nb_rows; r++)
+            {
+                int code = l.depthwise ? codes[ko*nb_rows + r] : codes[(ko*nb_rows + r)*l.k_in + ki];
+                for (int bit=0; bit<l.qw; bit++)
+                {
+                    int index = ((((l.depthwise ? 0 : ko)*nb_ki + kim)*l.qw + bit)*nb_rows + r)*plane + c/8;
+                    bytes[index] |= ((code >> bit) & 1) << (c % 8);
+                }
+            }
+        }
+    }
+    return bytes;
+}
+
+
+static void ne16_weight_strides(const Layer &l, uint32_t *regs)
+{
+    int tp = l.mode16 ? 8 : 16;
+    int plane = tp / 8;
+    int packet = l.nb_taps() * plane;
+    int nb_ki = div_up(l.k_in, l.linear ? 256 : tp);
+
+    if (l.linear)
+    {
+        regs[HWPE_REG_WEIGHTS_D0_STRIDE] = l.k_in / 8;
+        regs[HWPE_REG_WEIGHTS_D1_STRIDE] = l.qw * l.k_in / 8;
+    }
+    else
+    {
+        regs[HWPE_REG_WEIGHTS_D0_STRIDE] = packet;
+        regs[HWPE_REG_WEIGHTS_D1_STRIDE] = l.depthwise ? 0 : nb_ki * l.qw * packet;
+    }
+    regs[HWPE_REG_WEIGHTS_D2_STRIDE] = 0;
+}
+
+
+// NE16 can only mask whole border rows and columns, given as top/right/bottom/left counts
+static uint32_t ne16_filter_mask(int mask)
+{
+    auto row = [mask](int r) { return ((mask >> (r*3)) & 0x7) == 0x7; };
+    auto col = [mask](int c) { return ((mask >> c) & 0x49) == 0x49; };
+
+    int top = 0, bottom = 0, left = 0, right = 0;
+    while (top < 3 && row(top)) top++;
+    while (bottom < 3 - top && row(2 - bottom)) bottom++;
+    while (left < 3 && col(left)) left++;
+    while (right < 3 - left && col(2 - right)) right++;
+
+    int covered = 0;
+    for (int i=0; i<9; i++)
+    {
+        int r = i / 3, c = i % 3;
+        if (r < top || r >= 3 - bottom || c < left || c >= 3 - right)
+        {
+            covered |= 1 << i;
+        }
+    }
+    if (covered != mask)
+    {
+        throw std::runtime_error("Filter mask not made of border rows and columns");
+    }
+    return (top << 24) | (right << 16) | (bottom << 8) | left;
+}
+
+
+static uint32_t ne16_config_bits(const Layer &l)
+{
+    return 0;
+}
+
+
+static Arch ne16_arch = {
+    "ne16", 0x20000, 3, 16, 16, 16, 32,
+    ne16_pack_weights, ne16_weight_strides, ne16_filter_mask, ne16_config_bits
+};
+
+
+static Layer ne16_random_layer(const Arch &arch, Rng &rng)
+{
+    Layer l = random_layer(arch, rng, true, true, false);
+    if (l.filter_mask)
+    {
+        int top = rng.range(0, 1), right = rng.range(0, 1), bottom = rng.range(0, 1), left = rng.range(0, 1);
+        l.filter_mask = 0;
+        for (int i=0; i<9; i++)
+        {
+            int r = i / 3, c = i % 3;
+            if (r < top || r >= 3 - bottom || c < left || c >= 3 - right)
+            {
+                l.filter_mask |= 1 << i;
+            }
+        }
+    }
+    return l;
+}
+
+
+static std::vector<Layer> ne16_layers()
+{
+    std::vector<Layer> layers;
+    Layer l;
+
+    l = Layer("3x3", 3, 40, 40, 7, 5);
+    l.bias = true;
+    layers.push_back(l);
+
+    l = Layer("3x3 32-bit", 3, 20, 12, 4, 4);
+    l.qw = 4;
+    l.out_bits = 32;
+    l.quant = false;
+    layers.push_back(l);
+
+    l = Layer("3x3 32-bit quant", 3, 20, 36, 4, 2);
+    l.out_bits = 32;
+    l.norm_bits = 16;
+    l.shift = true;
+    layers.push_back(l);
+
+    l = Layer("depthwise", 3, 24, 24, 5, 6);
+    l.depthwise = true;
+    l.relu = false;
+    l.bias = true;
+    l.norm_bits = 32;
+    layers.push_back(l);
+
+    l = Layer("1x1", 1, 40, 36, 5, 4);
+    l.qw = 6;
+    l.shift = true;
+    layers.push_back(l);
+
+    l = Layer("1x1 32-bit", 1, 33, 20, 4, 7);
+    l.qw = 2;
+    l.out_bits = 32;
+    l.quant = false;
+    layers.push_back(l);
+
+    l = Layer("linear", 1, 560, 40, 1, 1);
+    l.linear = true;
+    l.bias = true;
+    layers.push_back(l);
+
+    l = Layer("linear 32-bit", 1, 96, 20, 1, 1);
+    l.linear = true;
+    l.qw = 3;
+    l.out_bits = 32;
+    l.quant = false;
+    layers.push_back(l);
+
+    l = Layer("padding top/left", 3, 20, 16, 5, 4);
+    l.pad_top = l.pad_left = 1;
+    l.pad_value = 37;
+    layers.push_back(l);
+
+    l = Layer("padding", 3, 20, 16, 6, 7);
+    l.pad_top = l.pad_right = l.pad_bottom = l.pad_left = 1;
+    l.relu = false;
+    layers.push_back(l);
+
+    l = Layer("strided 2x2", 3, 20, 24, 3, 4);
+    l.strided = true;
+    l.nb_jobs = 2;
+    l.preload = true;
+    layers.push_back(l);
+
+    l = Layer("strided 2x2 depthwise", 3, 20, 20, 4, 3);
+    l.strided = true;
+    l.depthwise = true;
+    l.out_bits = 32;
+    l.quant = false;
+    layers.push_back(l);
+
+    l = Layer("filter mask", 3, 20, 16, 4, 5);
+    l.filter_mask = 0x007 | 0x049;
+    layers.push_back(l);
+
+    l = Layer("mode16 3x3", 3, 12, 20, 4, 4);
+    l.mode16 = true;
+    l.qw = 4;
+    l.out_bits = 32;
+    l.quant = false;
+    layers.push_back(l);
+
+    l = Layer("mode16 1x1", 1, 10, 20, 4, 5);
+    l.mode16 = true;
+    l.out_bits = 32;
+    l.quant = false;
+    layers.push_back(l);
+
+    l = Layer("qw 1", 3, 16, 32, 3, 3);
+    l.qw = 1;
+    l.nb_jobs = 4;
+    layers.push_back(l);
+
+    return layers;
+}
+
+
+int main(int argc, char **argv)
+{
+    int nb_random = argc > 1 ? atoi(argv[1]) : 200;
+    uint64_t seed = argc > 2 ? strtoull(argv[2], NULL, 0) : 1;
+
+    return run_tests(ne16_arch, ne16_layers(), nb_random, seed, ne16_random_layer);
+}
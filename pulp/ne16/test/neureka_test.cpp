@@ -0,0 +1,173 @@
+/*
+ * Copyright (C) 2024 ETH Zurich and University of Bologna
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * Neureka regression test, usage: neureka_test [nb_random_layers] [seed]
+ * Neureka has no linear nor 16-bit activation mode.
+ */
+
+#include "hwpe_test.hpp"
+
+
+// Weights are stored as 256-bit words. For 3x3 and depthwise filters, one word holds one bit
+// plane of a 28 channels tile, 28 channels per filter tap. For 1x1 filters, one word holds
+// all the bits of a 32 channels tile, interleaved by groups of 4 channels.
+static std::vector<uint8_t> neureka_pack_weights(const Layer &l, const std::vector<int> &codes)
+{
+    int tp = l.fs == 3 ? 28 : 32;
+    int nb_ki = div_up(l.depthwise ? l.k_out : l.k_in, tp);
+    int nb_ko = l.depthwise ? 1 : l.k_out;
+    int nb_planes = l.fs == 3 ? l.qw : 1;
+    std::vector<uint8_t> bytes(nb_ko * nb_ki * nb_planes * 32, 0);
+
+    for (int ko=0; ko<l.k_out; ko++)
+    {
+        for (int ki=0; ki<(l.depthwise ? 1 : l.k_in); ki++)
+        {
+            int ch = l.depthwise ? ko : ki;
+            int kim = ch / tp, c = ch % tp;
+            for (int r=0; r<l.nb_taps(); r++)
+            {
+                int code = l.depthwise ? codes[ko*l.nb_taps() + r] : codes[(ko*l.nb_taps() + r)*l.k_in + ki];
+                for (int bit=0; bit<l.qw; bit++)
+                {
+                    int word = ((l.depthwise ? 0 : ko)*nb_ki + kim)*nb_planes + (l.fs == 3 ? bit : 0);
+                    int index = l.fs == 3 ? r*28 + c : 32*(c/4) + 4*bit + c%4;
+                    bytes[word*32 + index/8] |= ((code >> bit) & 1) << (index % 8);
+                }
+            }
+        }
+    }
+    return bytes;
+}
+
+
+static void neureka_weight_strides(const Layer &l, uint32_t *regs)
+{
+    int nb_ki = div_up(l.k_in, l.fs == 3 ? 28 : 32);
+    regs[HWPE_REG_WEIGHTS_D0_STRIDE] = 32;
+    regs[HWPE_REG_WEIGHTS_D1_STRIDE] = l.depthwise ? 0 : l.fs == 3 ? nb_ki * l.qw * 32 : nb_ki * 32;
+    regs[HWPE_REG_WEIGHTS_D2_STRIDE] = 0;
+}
+
+
+// Any set of taps can be masked
+static uint32_t neureka_filter_mask(int mask)
+{
+    return mask & 0x1ff;
+}
+
+
+static uint32_t neureka_config_bits(const Layer &l)
+{
+    return (l.signed_act << 26) | (l.wmem << 9);
+}
+
+
+static Arch neureka_arch = {
+    "neureka", 0x40000, 6, 28, 32, 28, 32,
+    neureka_pack_weights, neureka_weight_strides, neureka_filter_mask, neureka_config_bits
+};
+
+
+static Layer neureka_random_layer(const Arch &arch, Rng &rng)
+{
+    Layer l = random_layer(arch, rng, false, false, true);
+    l.wmem = rng.flip();
+    return l;
+}
+
+
+static std::vector<Layer> neureka_layers()
+{
+    std::vector<Layer> layers;
+    Layer l;
+
+    l = Layer("3x3", 3, 40, 40, 8, 7);
+    l.bias = true;
+    layers.push_back(l);
+
+    l = Layer("3x3 signed", 3, 30, 20, 6, 6);
+    l.signed_act = true;
+    l.shift = true;
+    layers.push_back(l);
+
+    l = Layer("3x3 signed 32-bit", 3, 30, 20, 5, 7);
+    l.signed_act = true;
+    l.relu = false;
+    l.out_bits = 32;
+    l.norm_bits = 16;
+    layers.push_back(l);
+
+    l = Layer("3x3 32-bit", 3, 20, 36, 4, 4);
+    l.qw = 3;
+    l.out_bits = 32;
+    l.quant = false;
+    layers.push_back(l);
+
+    l = Layer("depthwise", 3, 36, 36, 7, 6);
+    l.depthwise = true;
+    l.relu = false;
+    l.bias = true;
+    l.norm_bits = 32;
+    layers.push_back(l);
+
+    l = Layer("1x1", 1, 40, 20, 7, 8);
+    l.qw = 4;
+    l.out_bits = 32;
+    l.quant = false;
+    layers.push_back(l);
+
+    l = Layer("1x1 quant", 1, 70, 36, 3, 5);
+    l.norm_bits = 16;
+    l.shift = true;
+    layers.push_back(l);
+
+    l = Layer("padding top/left", 3, 20, 16, 5, 4);
+    l.pad_top = l.pad_left = 1;
+    l.pad_value = 37;
+    layers.push_back(l);
+
+    l = Layer("padding", 3, 20, 16, 8, 7);
+    l.pad_top = l.pad_right = l.pad_bottom = l.pad_left = 1;
+    l.relu = false;
+    layers.push_back(l);
+
+    l = Layer("filter mask", 3, 20, 16, 4, 5);
+    l.filter_mask = 0x111;
+    layers.push_back(l);
+
+    l = Layer("weight memory", 3, 30, 40, 4, 4);
+    l.wmem = true;
+    layers.push_back(l);
+
+    l = Layer("strided 2x2", 3, 20, 24, 3, 4);
+    l.strided = true;
+    l.nb_jobs = 2;
+    l.preload = true;
+    layers.push_back(l);
+
+    return layers;
+}
+
+
+int main(int argc, char **argv)
+{
+    int nb_random = argc > 1 ? atoi(argv[1]) : 200;
+    uint64_t seed = argc > 2 ? strtoull(argv[2], NULL, 0) : 1;
+
+    return run_tests(neureka_arch, neureka_layers(), nb_random, seed, neureka_random_layer);
+}
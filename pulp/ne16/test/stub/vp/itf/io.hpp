@@ -0,0 +1,103 @@
+/*
+ * Copyright (C) 2024 ETH Zurich and University of Bologna
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * Synchronous subset of the IO interface, see vp.hpp.
+ */
+
+#ifndef __VP_ITF_IO_HPP__
+#define __VP_ITF_IO_HPP__
+
+#include <vp/vp.hpp>
+#include <vp/itf/wire.hpp>
+
+namespace vp {
+
+typedef enum
+{
+    IO_REQ_OK,
+    IO_REQ_INVALID,
+    IO_REQ_DENIED,
+    IO_REQ_PENDING,
+} IoReqStatus;
+
+class IoReq
+{
+public:
+    void init()
+    {
+        this->addr = 0;
+        this->size = 0;
+        this->data = NULL;
+        this->is_write = false;
+        this->latency = 0;
+    }
+
+    uint64_t get_addr() { return this->addr; }
+    void set_addr(uint64_t addr) { this->addr = addr; }
+    uint64_t get_size() { return this->size; }
+    void set_size(uint64_t size) { this->size = size; }
+    uint8_t *get_data() { return this->data; }
+    void set_data(uint8_t *data) { this->data = data; }
+    bool get_is_write() { return this->is_write; }
+    void set_is_write(bool is_write) { this->is_write = is_write; }
+    int64_t get_latency() { return this->latency; }
+    void set_latency(int64_t latency) { this->latency = latency; }
+    void inc_latency(int64_t incr) { this->latency += incr; }
+
+private:
+    uint64_t addr = 0;
+    uint64_t size = 0;
+    uint8_t *data = NULL;
+    bool is_write = false;
+    int64_t latency = 0;
+};
+
+typedef IoReqStatus (IoReqMeth)(Block *, IoReq *);
+
+class IoSlave : public Port
+{
+    friend class IoMaster;
+
+public:
+    void set_req_meth(IoReqMeth *meth) { this->req_meth = meth; }
+
+private:
+    IoReqMeth *req_meth = NULL;
+};
+
+class IoMaster : public Port
+{
+public:
+    void bind_to(IoSlave *slave) { this->slave = slave; }
+    bool is_bound() { return this->slave != NULL; }
+
+    IoReqStatus req(IoReq *req)
+    {
+        if (this->slave == NULL)
+        {
+            return IO_REQ_INVALID;
+        }
+        return this->slave->req_meth(this->slave->owner, req);
+    }
+
+private:
+    IoSlave *slave = NULL;
+};
+
+};
+
+#endif
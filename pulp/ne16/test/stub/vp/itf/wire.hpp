@@ -0,0 +1,64 @@
+/*
+ * Copyright (C) 2024 ETH Zurich and University of Bologna
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * Wire interface, see vp.hpp.
+ */
+
+#ifndef __VP_ITF_WIRE_HPP__
+#define __VP_ITF_WIRE_HPP__
+
+#include <vp/vp.hpp>
+
+namespace vp {
+
+template<class T>
+class WireMaster;
+
+template<class T>
+class WireSlave : public Port
+{
+    friend class WireMaster<T>;
+
+public:
+    void set_sync_meth(void (*meth)(Block *, T)) { this->sync_meth = meth; }
+
+private:
+    void (*sync_meth)(Block *, T) = NULL;
+};
+
+template<class T>
+class WireMaster : public Port
+{
+public:
+    void bind_to(WireSlave<T> *slave) { this->slave = slave; }
+    bool is_bound() { return this->slave != NULL; }
+
+    void sync(T value)
+    {
+        if (this->slave != NULL && this->slave->sync_meth != NULL)
+        {
+            this->slave->sync_meth(this->slave->owner, value);
+        }
+    }
+
+private:
+    WireSlave<T> *slave = NULL;
+};
+
+};
+
+#endif
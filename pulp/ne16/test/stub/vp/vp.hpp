@@ -0,0 +1,238 @@
+/*
+ * Copyright (C) 2024 ETH Zurich and University of Bologna
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/*
+ * Minimal stand-in for the simulator runtime, with just what the NE16 and Neureka models use,
+ * so that they can be instantiated by the regression harness without the engine.
+ * Components share a single clock engine, which executes events in cycle order, and ports are
+ * bound directly by the harness. Traces are silent, except fatal errors which throw.
+ */
+
+#ifndef __VP_VP_HPP__
+#define __VP_VP_HPP__
+
+#include <stdint.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <functional>
+#include <map>
+#include <queue>
+#include <string>
+#include <vector>
+#include <stdexcept>
+
+using namespace std;
+
+namespace js {
+
+class Config
+{
+public:
+    void set(std::string name, int64_t value) { this->values[name] = value; }
+    int64_t get_child_int(std::string name) { return this->values.count(name) ? this->values[name] : 0; }
+    bool get_child_bool(std::string name) { return this->get_child_int(name) != 0; }
+
+private:
+    std::map<std::string, int64_t> values;
+};
+
+};
+
+namespace vp {
+
+enum
+{
+    ERROR,
+    WARNING,
+    INFO,
+    DEBUG,
+    TRACE,
+};
+
+class Block
+{
+public:
+    virtual ~Block() {}
+};
+
+class Trace
+{
+public:
+    enum
+    {
+        LEVEL_ERROR,
+        LEVEL_WARNING,
+        LEVEL_INFO,
+        LEVEL_DEBUG,
+        LEVEL_TRACE,
+    };
+
+    void msg(const char *fmt, ...) {}
+    void msg(int level, const char *fmt, ...) {}
+    void force_warning(const char *fmt, ...) {}
+    void event(uint8_t *value) {}
+
+    void fatal(const char *fmt, ...)
+    {
+        char buffer[1024];
+        va_list ap;
+        va_start(ap, fmt);
+        vsnprintf(buffer, sizeof(buffer), fmt, ap);
+        va_end(ap);
+        throw std::runtime_error(buffer);
+    }
+};
+
+class TraceEngine
+{
+public:
+    void new_trace(std::string name, Trace *trace, int level) {}
+    void new_trace_event(std::string name, Trace *trace, int width) {}
+};
+
+template<class T>
+class Register
+{
+public:
+    void set(T value) { this->value = value; }
+    T get() { return this->value; }
+
+private:
+    T value = 0;
+};
+
+typedef Register<uint8_t> reg_8;
+typedef Register<uint32_t> reg_32;
+
+class ClockEvent;
+typedef void (ClockEventMeth)(Block *, ClockEvent *);
+
+class ClockEvent
+{
+    friend class ClockEngine;
+
+public:
+    ClockEvent(Block *owner, ClockEventMeth *meth) : owner(owner), meth(meth) {}
+    bool is_enqueued() { return this->enqueued; }
+    int64_t get_cycle() { return this->cycle; }
+
+private:
+    Block *owner;
+    ClockEventMeth *meth;
+    bool enqueued = false;
+    int64_t cycle = 0;
+};
+
+// Executes the enqueued events in cycle order, events of the same cycle in enqueue order
+class ClockEngine
+{
+public:
+    int64_t get_cycles() { return this->cycles; }
+
+    void enqueue(ClockEvent *event, int64_t cycles)
+    {
+        event->enqueued = true;
+        event->cycle = this->cycles + cycles;
+        this->queue.push({event->cycle, this->seq++, event});
+    }
+
+    // Executes the next event, returns false if there is none
+    bool step()
+    {
+        if (this->queue.empty())
+        {
+            return false;
+        }
+        Entry entry = this->queue.top();
+        this->queue.pop();
+        this->cycles = entry.cycle;
+        entry.event->enqueued = false;
+        entry.event->meth(entry.event->owner, entry.event);
+        return true;
+    }
+
+private:
+    struct Entry
+    {
+        int64_t cycle;
+        int64_t seq;
+        ClockEvent *event;
+        bool operator<(const Entry &other) const
+        {
+            return this->cycle != other.cycle ? this->cycle > other.cycle : this->seq > other.seq;
+        }
+    };
+
+    int64_t cycles = 0;
+    int64_t seq = 0;
+    std::priority_queue<Entry> queue;
+};
+
+class Port
+{
+    friend class Component;
+
+public:
+    virtual ~Port() {}
+
+protected:
+    Block *owner = NULL;
+};
+
+struct ComponentConf
+{
+    js::Config *config;
+    ClockEngine *clock;
+};
+
+class Component : public Block
+{
+public:
+    Component(ComponentConf &config) : clock(*config.clock), config(config.config) {}
+
+    virtual void reset(bool active) {}
+
+    js::Config *get_js_config() { return this->config; }
+
+    template<class T>
+    void new_reg(std::string name, Register<T> *reg, uint64_t reset_val, bool reset=true) { reg->set(reset_val); }
+
+    void new_master_port(std::string name, Port *port) { this->new_port(name, port, this); }
+    void new_slave_port(std::string name, Port *port, Block *owner=NULL) { this->new_port(name, port, owner ? owner : this); }
+
+    // Returns the port declared under this name, used by the harness for binding
+    Port *get_port(std::string name) { return this->ports.count(name) ? this->ports[name] : NULL; }
+
+    ClockEvent *event_new(ClockEventMeth *meth) { return new ClockEvent(this, meth); }
+    void event_enqueue(ClockEvent *event, int64_t cycles) { this->clock.enqueue(event, cycles); }
+
+    TraceEngine traces;
+    ClockEngine &clock;
+
+private:
+    void new_port(std::string name, Port *port, Block *owner)
+    {
+        port->owner = owner;
+        this->ports[name] = port;
+    }
+
+    js::Config *config;
+    std::map<std::string, Port *> ports;
+};
+
+};
+
+#endif
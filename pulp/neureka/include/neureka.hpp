@@ -32,6 +32,8 @@
 #include <assert.h>
 #include <string>
 #include <bitset>
+#include <array>
+#include <vector>
 #include "xtensor/xarray.hpp"
 #include "xtensor/xio.hpp"
 #include "xtensor/xview.hpp"
@@ -67,6 +69,8 @@
 #define NEUREKA_REG_CONFIG0           23
 
 #define NEUREKA_NB_REG 24
+// Size of the address range of the HWPE slave port, which holds the direct context windows
+#define NEUREKA_SLAVE_SIZE 0x400
 
 #define NEUREKA_SPECIAL_TRACE_REG NEUREKA_NB_REG
 #define NEUREKA_SPECIAL_FORMAT_TRACE_REG NEUREKA_NB_REG+1
@@ -89,6 +93,8 @@ enum NeurekaState {
     END
 };
 
+#define NEUREKA_NB_STATES (END+1)
+
 enum NeurekaTraceLevel {
     L0_CONFIG,
     L1_ACTIV_INOUT,
@@ -199,6 +205,11 @@ public:
     vp::IoMaster wmem_out;
     vp::reg_32 state;
     vp::reg_8 activity;
+    vp::reg_8 job_queue;
+
+    // PERFORMANCE counters of the running job, streamer latencies are accumulated by the streamers
+    int64_t perf_load_latency;
+    int64_t perf_store_latency;
     NeurekaTraceLevel trace_level;
     int trace_format;
 
@@ -243,6 +254,17 @@ private:
     void debug_accum();
     void debug_psum_block();
 
+    // PERFORMANCE counters
+    void perf_setup();
+    void perf_clear();
+    void perf_report(int job_id);
+    int64_t perf_state_cycles[NEUREKA_NB_STATES];
+    int64_t perf_job_start;
+    vp::Trace perf_state_events[NEUREKA_NB_STATES];
+    vp::Trace perf_job_cycles_event;
+    vp::Trace perf_load_latency_event;
+    vp::Trace perf_store_latency_event;
+
     // EVENT handlers
     static void fsm_start_handler(vp::Block *__this, vp::ClockEvent *event);
     static void fsm_handler(vp::Block *__this, vp::ClockEvent *event);
@@ -263,16 +285,21 @@ private:
     void printout();
 
     // REGISTER FILE and HWPE CTRL
-    int  cxt0[NEUREKA_NB_REG];
-    int  cxt1[NEUREKA_NB_REG];
+    std::vector<std::array<int, NEUREKA_NB_REG>> cxt; // one register context per job queue slot
     int  cxt_cfg_ptr;
     int  cxt_use_ptr;
     int  job_pending;
     int  job_state;
     unsigned char job_id;
-    int cxt_job_id[2];
+    std::vector<int> cxt_job_id;
     char running_job_id;
     int  job_running;
+    int  nb_jobs;               // depth of the job queue, i.e. number of register contexts
+    uint32_t reg_mask;          // slave address bits decoded, covers the direct windows of all contexts
+    bool job_preload;           // next context is copied in while the current job streams out
+    int  job_preload_credit;    // cycles of the previous job's last streamout still hiding control overheads
+    int  streamout_tile_cycles; // cycles spent in STREAMOUT for the current tile
+    int  preload_overlap(int latency);
 
     // REGISTER FILE configuration parameters
     int weights_ptr;
@@ -18,8 +18,13 @@ import gvsoc.systree as st
 
 class Neureka(st.Component):
 
-    def __init__(self, parent, name):
+    def __init__(self, parent, name, nb_jobs: int=2, job_preload: bool=False):
 
         super(Neureka, self).__init__(parent, name)
 
         self.set_component('pulp.neureka.neureka')
+
+        self.add_properties({
+            'nb_jobs': nb_jobs,
+            'job_preload': job_preload,
+        })
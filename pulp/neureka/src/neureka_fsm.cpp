@@ -32,6 +32,7 @@ void Neureka::fsm_start_handler(vp::Block *__this, vp::ClockEvent *event) {
   // clear state and propagate context
   _this->clear_all();
   _this->regfile_cxt();
+  _this->perf_clear();
   _this->job_running = 1;
 
   // convenience parameters used internally in the model, but not set by register file
@@ -95,20 +96,30 @@ void Neureka::fsm_end_handler(vp::Block *__this, vp::ClockEvent *event) {
   int job_id = _this->cxt_job_id[_this->cxt_use_ptr];
   _this->job_running = 0;
   _this->cxt_job_id[_this->cxt_use_ptr] = -1;
-  _this->cxt_use_ptr = 1-_this->cxt_use_ptr;
+  _this->cxt_use_ptr = (_this->cxt_use_ptr + 1) % _this->nb_jobs;
   _this->job_pending--;
+  _this->job_queue.set(_this->job_pending);
   _this->irq.sync(true);
   _this->start_cycles = _this->fsm_start_event->get_cycle();
   std::cout<<"FSM START EVENT CYCLES="<<_this->start_cycles<<std::endl;
   std::cout<<"TOTAL CYCLES="<<(_this->end_cycles - _this->start_cycles)<<std::endl;
   _this->trace.msg(vp::Trace::LEVEL_INFO, "Ending job (id=%d).\n", job_id);
+  _this->perf_report(job_id);
+  _this->activity.set(0);
+  _this->state.set(IDLE);
   if (!_this->fsm_start_event->is_enqueued() && _this->job_pending > 0) {
+    if (_this->job_preload) {
+      // the next context was copied in during the last streamout, so there is no inter-job bubble
+      _this->job_preload_credit = _this->streamout_tile_cycles;
+      _this->trace.msg(vp::Trace::LEVEL_INFO, "Starting a preloaded job from the queue.\n");
+      Neureka::fsm_start_handler(_this, NULL);
+    }
+    else {
       _this->event_enqueue(_this->fsm_start_event, 1);
       _this->trace.msg(vp::Trace::LEVEL_DEBUG, "FSM Start Event enqueued with cycles=%d\n", _this->fsm_start_event->get_cycle());
       _this->trace.msg(vp::Trace::LEVEL_INFO, "Starting a new job from the queue.\n");
+    }
   }
-  _this->activity.set(0);
-  _this->state.set(IDLE);
 }
 
 void Neureka::fsm_loop() {
@@ -136,6 +147,14 @@ void Neureka::fsm_loop() {
   }
 }
 
+// Hides a fixed control overhead of the first tile of a preloaded job behind
+// the final streamout of the previous job, returns the remaining latency
+int Neureka::preload_overlap(int latency) {
+  auto hidden = std::min(latency, this->job_preload_credit);
+  this->job_preload_credit -= hidden;
+  return latency - hidden;
+}
+
 int Neureka::fsm() {
   auto state_next = this->state.get();
   auto latency = 0;
@@ -190,6 +209,7 @@ int Neureka::fsm() {
         this->trace.msg(vp::Trace::LEVEL_DEBUG, "State START_STREAMIN\n");
       }
       this->constant_setup();
+      this->streamout_tile_cycles = 0;
       if(this->streamin) {
         this->streamin_setup();
         state_next = STREAMIN;
@@ -247,7 +267,7 @@ int Neureka::fsm() {
 
       // emulate 6 cycles of latency due to FIFOs + ctrl
       // this->trace.msg(vp::Trace::LEVEL_DEBUG, "  Before streamin load cycle=%d\n", latency);
-      latency += 6;
+      latency += this->preload_overlap(6);
       if(this->activation_prefetch)
         this->load_latency = 3;
       // this->trace.msg(vp::Trace::LEVEL_DEBUG, "  After streamin load cycle=%d\n", latency);
@@ -318,17 +338,17 @@ int Neureka::fsm() {
       // emulate 6 cycles of latency due to FIFOs + ctrl (10 for 1x1 layers)
       if(this->depthwise && this->dw_iter == 0) {
 
-        latency += 34; // Depthwise weight offset cycles
+        latency += this->preload_overlap(34); // Depthwise weight offset cycles
         if(this->activation_prefetch)
           this->matrixvec_latency = 34;
       }
       else if(!this->depthwise) {
         if(this->activation_prefetch){
           this->matrixvec_latency = this->fs == 1 ? 7 : 6;
-          latency += this->fs == 1 ? 7 : 6;
+          latency += this->preload_overlap(this->fs == 1 ? 7 : 6);
         }
         else{
-          latency += this->fs == 1 ? 10 : 6;
+          latency += this->preload_overlap(this->fs == 1 ? 10 : 6);
 
         }
       }
@@ -470,6 +490,7 @@ int Neureka::fsm() {
         this->trace.msg(vp::Trace::LEVEL_DEBUG, "  streamout_j_out_iter=%d\n", this->streamout_j_out_iter);
       }
       // this->trace.msg(vp::Trace::LEVEL_DEBUG, "  Before streamout cycle =%d\n", latency);
+      this->job_preload_credit = 0;
       latency = this->streamout_cycle();
       // this->trace.msg(vp::Trace::LEVEL_DEBUG, "  After streamout cycle =%d\n", latency);
       if(this->streamout_exit_idx()) {
@@ -498,6 +519,7 @@ int Neureka::fsm() {
       else {
         this->streamout_update_idx();
       }
+      this->streamout_tile_cycles += latency;
       break;
 
     case END:
@@ -513,6 +535,7 @@ int Neureka::fsm() {
   this->trace.msg(vp::Trace::LEVEL_DEBUG, "MATRIXVEC LATENCY= %d\n", this->matrixvec_latency);
   this->trace.msg(vp::Trace::LEVEL_DEBUG, "LATENCY= %d\n", latency);
 
+  this->perf_state_cycles[this->state.get()] += latency;
   this->state.set(state_next);
   return latency;
 }
@@ -37,18 +37,13 @@ int Neureka::regfile_rd(int addr) {
     }
   }
   else if(addr < NEUREKA_NB_REG) {
-    if (this->cxt_cfg_ptr == 0) {
-      return this->cxt0[addr];
-    }
-    else {
-      return this->cxt1[addr];
-    }
+    return this->cxt[this->cxt_cfg_ptr][addr];
   }
-  else if (addr < 2*NEUREKA_NB_REG) {
-    return this->cxt0[addr - NEUREKA_NB_REG];
+  else if (addr < (this->nb_jobs+1)*NEUREKA_NB_REG) {
+    return this->cxt[addr/NEUREKA_NB_REG - 1][addr % NEUREKA_NB_REG];
   }
   else {
-    return this->cxt1[addr - 2*NEUREKA_NB_REG];
+    return 0;
   }
 }
 
@@ -71,18 +66,10 @@ void Neureka::regfile_wr(int addr, int value) {
     this->trace_format = value;
   }
   else if(addr < NEUREKA_NB_REG) {
-    if (this->cxt_cfg_ptr == 0) {
-      this->cxt0[addr] = value;
-    }
-    else if(this->cxt_cfg_ptr == 1) {
-      this->cxt1[addr] = value;
-    }
-  }
-  else if (addr < 2*NEUREKA_NB_REG) {
-    this->cxt0[addr - NEUREKA_NB_REG] = value;
+    this->cxt[this->cxt_cfg_ptr][addr] = value;
   }
-  else {
-    this->cxt1[addr - 2*NEUREKA_NB_REG] = value;
+  else if (addr < (this->nb_jobs+1)*NEUREKA_NB_REG) {
+    this->cxt[addr/NEUREKA_NB_REG - 1][addr % NEUREKA_NB_REG] = value;
   }
 }
 
@@ -90,7 +77,7 @@ void Neureka::regfile_cxt() {
 
   for(auto addr=0; addr<NEUREKA_NB_REG; addr++) {
 
-    auto value = this->cxt_use_ptr == 0 ? this->cxt0[addr] : this->cxt1[addr];
+    auto value = this->cxt[this->cxt_use_ptr][addr];
 
     switch(addr) {
 
@@ -363,18 +350,19 @@ void Neureka::commit() {
   this->trace.msg(vp::Trace::LEVEL_DEBUG, "JOB COMMITTED: job_state=%d job_pending=%d job_running=%d\n", this->job_state, this->job_pending, this->job_running);
   this->job_pending++;
   this->job_state = 0;
-  this->cxt_cfg_ptr = 1-this->cxt_cfg_ptr;
+  this->cxt_cfg_ptr = (this->cxt_cfg_ptr + 1) % this->nb_jobs;
+  this->job_queue.set(this->job_pending);
 }
 
 int Neureka::acquire() {
   this->trace.msg(vp::Trace::LEVEL_DEBUG, "JOB ACQUIRED: job_state=%d job_pending=%d job_running=%d\n", this->job_state, this->job_pending, this->job_running);
-  if(this->job_state == 0 & this->job_pending < 2) {
+  if(this->job_state == 0 & this->job_pending < this->nb_jobs) {
     int job_id = (int) this->job_id++;
     this->cxt_job_id[this->cxt_cfg_ptr] = job_id;
     this->job_state = -2;
     return job_id;
   }
-  else if(this->job_pending == 2) {
+  else if(this->job_pending == this->nb_jobs) {
     return -1;
   }
   else {
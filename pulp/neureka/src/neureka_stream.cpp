@@ -221,6 +221,7 @@ xt::xarray<T> NeurekaVectorLoad<T>::ex(int width, bool w_demux, int64_t& cycles)
   if (this->neureka->trace_level == L3_ALL) {
     this->neureka->trace.msg(vp::Trace::LEVEL_DEBUG, s.c_str());
   }
+  this->neureka->perf_load_latency += max_latency;
   cycles += max_latency + 1;
   return x;
 }
@@ -333,6 +334,7 @@ xt::xarray<T> NeurekaVectorStore<T>::ex(xt::xarray<T> data, int width, int64_t&
       this->neureka->trace.msg(vp::Trace::LEVEL_DEBUG, s.c_str());
     }
   }
+  this->neureka->perf_store_latency += max_latency;
   cycles += max_latency + 1;
   
   return data;
@@ -0,0 +1,173 @@
+/*
+ * Copyright (C) 2024 ETH Zurich and University of Bologna
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <vector>
+#include <vp/vp.hpp>
+#include <vp/itf/wire.hpp>
+
+
+/*
+ * Node of a hierarchical hardware barrier.
+ * Each input raises its request line once all the cores below it reached the barrier.
+ * When all inputs are there, the request is forwarded to the parent node if there is one,
+ * and the acknowledge coming back from it is broadcasted to all inputs. The root node
+ * directly sends the acknowledge. Each hop, up or down, takes the node latency.
+ */
+class GlobalBarrier : public vp::Component
+{
+
+public:
+    GlobalBarrier(vp::ComponentConf &config);
+
+    void reset(bool active);
+
+private:
+    static void input_req_sync(vp::Block *__this, bool value, int id);
+    static void output_ack_sync(vp::Block *__this, bool value);
+    static void up_handler(vp::Block *__this, vp::ClockEvent *event);
+    static void down_handler(vp::Block *__this, vp::ClockEvent *event);
+
+    vp::Trace trace;
+
+    int nb_inputs;
+    int latency;
+
+    std::vector<vp::WireSlave<bool>> input_req_itf;
+    vp::WireMaster<bool> input_ack_itf;
+    vp::WireMaster<bool> output_req_itf;
+    vp::WireSlave<bool> output_ack_itf;
+
+    vp::ClockEvent up_event;
+    vp::ClockEvent down_event;
+
+    vp::reg_32 status;
+    int64_t nb_barriers;
+};
+
+
+
+GlobalBarrier::GlobalBarrier(vp::ComponentConf &config)
+    : vp::Component(config), up_event(this, &GlobalBarrier::up_handler),
+    down_event(this, &GlobalBarrier::down_handler)
+{
+    this->traces.new_trace("trace", &this->trace, vp::DEBUG);
+
+    this->nb_inputs = this->get_js_config()->get("nb_inputs")->get_int();
+    this->latency = this->get_js_config()->get("latency")->get_int();
+
+    // The status register has one bit per input
+    if (this->nb_inputs < 1 || this->nb_inputs > 32)
+    {
+        this->trace.fatal("Invalid number of inputs, must be between 1 and 32 (nb_inputs: %d)\n",
+            this->nb_inputs);
+        return;
+    }
+
+    this->input_req_itf.resize(this->nb_inputs);
+    for (int i=0; i<this->nb_inputs; i++)
+    {
+        this->input_req_itf[i].set_sync_meth_muxed(&GlobalBarrier::input_req_sync, i);
+        this->new_slave_port("input_req_" + std::to_string(i), &this->input_req_itf[i]);
+    }
+
+    this->new_master_port("input_ack", &this->input_ack_itf);
+    this->new_master_port("output_req", &this->output_req_itf);
+
+    this->output_ack_itf.set_sync_meth(&GlobalBarrier::output_ack_sync);
+    this->new_slave_port("output_ack", &this->output_ack_itf);
+
+    this->new_reg("status", &this->status, 0, true);
+}
+
+
+
+void GlobalBarrier::reset(bool active)
+{
+    if (active)
+    {
+        this->nb_barriers = 0;
+    }
+}
+
+
+
+void GlobalBarrier::input_req_sync(vp::Block *__this, bool value, int id)
+{
+    GlobalBarrier *_this = (GlobalBarrier *)__this;
+
+    if (!value)
+    {
+        return;
+    }
+
+    _this->status.set(_this->status.get() | (1ULL << id));
+
+    _this->trace.msg(vp::Trace::LEVEL_DEBUG, "Barrier request (input: %d, status: 0x%x)\n",
+        id, _this->status.get());
+
+    if (_this->status.get() == (1ULL << _this->nb_inputs) - 1)
+    {
+        _this->status.set(0);
+        _this->nb_barriers++;
+
+        if (_this->output_req_itf.is_bound())
+        {
+            _this->trace.msg(vp::Trace::LEVEL_DEBUG, "All inputs reached, forwarding to parent\n");
+            _this->up_event.enqueue(_this->latency ? _this->latency : 1);
+        }
+        else
+        {
+            _this->trace.msg(vp::Trace::LEVEL_DEBUG, "Barrier reached (count: %ld)\n", _this->nb_barriers);
+            _this->down_event.enqueue(_this->latency ? _this->latency : 1);
+        }
+    }
+}
+
+
+
+void GlobalBarrier::output_ack_sync(vp::Block *__this, bool value)
+{
+    GlobalBarrier *_this = (GlobalBarrier *)__this;
+
+    if (value)
+    {
+        _this->down_event.enqueue(_this->latency ? _this->latency : 1);
+    }
+}
+
+
+
+void GlobalBarrier::up_handler(vp::Block *__this, vp::ClockEvent *event)
+{
+    GlobalBarrier *_this = (GlobalBarrier *)__this;
+    _this->output_req_itf.sync(true);
+}
+
+
+
+void GlobalBarrier::down_handler(vp::Block *__this, vp::ClockEvent *event)
+{
+    GlobalBarrier *_this = (GlobalBarrier *)__this;
+    _this->trace.msg(vp::Trace::LEVEL_DEBUG, "Releasing inputs\n");
+    _this->input_ack_itf.sync(true);
+}
+
+
+
+extern "C" vp::Component *gv_new(vp::ComponentConf &config)
+{
+    return new GlobalBarrier(config);
+}
@@ -0,0 +1,43 @@
+#
+# Copyright (C) 2024 ETH Zurich and University of Bologna
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+#
+
+import gvsoc.systree
+
+
+class GlobalBarrier(gvsoc.systree.Component):
+
+    def __init__(self, parent: gvsoc.systree.Component, name: str, nb_inputs: int, latency: int=1):
+
+        super().__init__(parent, name)
+
+        self.add_sources(['pulp/snitch/global_barrier.cpp'])
+
+        self.add_properties({
+            'nb_inputs': nb_inputs,
+            'latency': latency
+        })
+
+    def i_INPUT_REQ(self, id: int) -> gvsoc.systree.SlaveItf:
+        return gvsoc.systree.SlaveItf(self, f'input_req_{id}', signature='wire<bool>')
+
+    def o_INPUT_ACK(self, itf: gvsoc.systree.SlaveItf):
+        self.itf_bind('input_ack', itf, signature='wire<bool>')
+
+    def o_OUTPUT_REQ(self, itf: gvsoc.systree.SlaveItf):
+        self.itf_bind('output_req', itf, signature='wire<bool>')
+
+    def i_OUTPUT_ACK(self) -> gvsoc.systree.SlaveItf:
+        return gvsoc.systree.SlaveItf(self, 'output_ack', signature='wire<bool>')
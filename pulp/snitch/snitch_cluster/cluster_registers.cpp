@@ -39,6 +39,10 @@ public:
 
 private:
     static void barrier_sync(vp::Block *__this, bool value, int id);
+    static void global_barrier_ack_sync(vp::Block *__this, bool value);
+    void hw_barrier_req(uint64_t reg_offset, int size, uint8_t *value, bool is_write);
+    vp::IoReqStatus hw_barrier_enqueue(vp::IoReq *req);
+    void hw_barrier_release();
     void cl_clint_set_req(uint64_t reg_offset, int size, uint8_t *value, bool is_write);
     void cl_clint_clear_req(uint64_t reg_offset, int size, uint8_t *value, bool is_write);
 
@@ -56,6 +60,15 @@ private:
     vp::WireMaster<bool> barrier_ack_itf;
 
     std::vector<vp::WireMaster<bool>> external_irq_itf;
+
+    // Loads to HW_BARRIER are kept pending until all cores did it. The barrier is local to
+    // the cluster unless global_barrier is set, in which case it is then forwarded to the
+    // global barrier.
+    bool global_barrier;
+    bool hw_barrier_access;
+    std::vector<vp::IoReq *> hw_barrier_reqs;
+    vp::WireMaster<bool> global_barrier_req_itf;
+    vp::WireSlave<bool> global_barrier_ack_itf;
 };
 
 ClusterRegisters::ClusterRegisters(vp::ComponentConf &config)
@@ -68,6 +81,7 @@ ClusterRegisters::ClusterRegisters(vp::ComponentConf &config)
 
     this->bootaddr = this->get_js_config()->get("boot_addr")->get_int();
     this->nb_cores = this->get_js_config()->get("nb_cores")->get_int();
+    this->global_barrier = this->get_js_config()->get("global_barrier")->get_bool();
 
     this->barrier_req_itf.resize(this->nb_cores);
     for (int i=0; i<this->nb_cores; i++)
@@ -84,9 +98,14 @@ ClusterRegisters::ClusterRegisters(vp::ComponentConf &config)
 
     this->new_master_port("barrier_ack", &this->barrier_ack_itf);
 
+    this->new_master_port("global_barrier_req", &this->global_barrier_req_itf);
+    this->global_barrier_ack_itf.set_sync_meth(&ClusterRegisters::global_barrier_ack_sync);
+    this->new_slave_port("global_barrier_ack", &this->global_barrier_ack_itf);
+
     this->regmap.build(this, &this->trace, "regmap");
     this->regmap.cl_clint_set.register_callback(std::bind(&ClusterRegisters::cl_clint_set_req, this, _1, _2, _3, _4));
     this->regmap.cl_clint_clear.register_callback(std::bind(&ClusterRegisters::cl_clint_clear_req, this, _1, _2, _3, _4));
+    this->regmap.hw_barrier.register_callback(std::bind(&ClusterRegisters::hw_barrier_req, this, _1, _2, _3, _4));
 }
 
 vp::IoReqStatus ClusterRegisters::req(vp::Block *__this, vp::IoReq *req)
@@ -99,11 +118,70 @@ vp::IoReqStatus ClusterRegisters::req(vp::Block *__this, vp::IoReq *req)
 
     _this->trace.msg("Received IO req (offset: 0x%llx, size: 0x%llx, is_write: %d)\n", offset, size, is_write);
 
+    _this->hw_barrier_access = false;
     _this->regmap.access(offset, size, data, is_write);
 
+    if (_this->hw_barrier_access)
+    {
+        return _this->hw_barrier_enqueue(req);
+    }
+
     return vp::IO_REQ_OK;
 }
 
+void ClusterRegisters::hw_barrier_req(uint64_t reg_offset, int size, uint8_t *value, bool is_write)
+{
+    this->regmap.hw_barrier.update(reg_offset, size, value, is_write);
+    this->hw_barrier_access = !is_write;
+}
+
+vp::IoReqStatus ClusterRegisters::hw_barrier_enqueue(vp::IoReq *req)
+{
+    this->hw_barrier_reqs.push_back(req);
+
+    this->trace.msg(vp::Trace::LEVEL_DEBUG, "HW barrier load (arrived: %d)\n", (int)this->hw_barrier_reqs.size());
+
+    if ((int)this->hw_barrier_reqs.size() == this->nb_cores)
+    {
+        if (this->global_barrier && this->global_barrier_req_itf.is_bound())
+        {
+            this->trace.msg(vp::Trace::LEVEL_DEBUG, "HW barrier reached, forwarding to global barrier\n");
+            this->global_barrier_req_itf.sync(true);
+        }
+        else
+        {
+            this->trace.msg(vp::Trace::LEVEL_DEBUG, "HW barrier reached\n");
+            // Reply to the last core directly and to the others through their pending requests
+            this->hw_barrier_reqs.pop_back();
+            this->hw_barrier_release();
+            return vp::IO_REQ_OK;
+        }
+    }
+
+    // The core is stalled on the load until the barrier is released
+    return vp::IO_REQ_PENDING;
+}
+
+void ClusterRegisters::hw_barrier_release()
+{
+    for (vp::IoReq *req: this->hw_barrier_reqs)
+    {
+        req->get_resp_port()->resp(req);
+    }
+    this->hw_barrier_reqs.clear();
+}
+
+void ClusterRegisters::global_barrier_ack_sync(vp::Block *__this, bool value)
+{
+    ClusterRegisters *_this = (ClusterRegisters *)__this;
+
+    if (value)
+    {
+        _this->trace.msg(vp::Trace::LEVEL_DEBUG, "Global barrier reached\n");
+        _this->hw_barrier_release();
+    }
+}
+
 void ClusterRegisters::barrier_sync(vp::Block *__this, bool value, int id)
 {
     ClusterRegisters *_this = (ClusterRegisters *)__this;
@@ -123,6 +201,11 @@ void ClusterRegisters::barrier_sync(vp::Block *__this, bool value, int id)
 void ClusterRegisters::reset(bool active)
 {
     this->new_reg("barrier_status", &this->barrier_status, 0, true);
+
+    if (active)
+    {
+        this->hw_barrier_reqs.clear();
+    }
 }
 
 
@@ -21,14 +21,15 @@ import regmap.regmap_c_header
 
 class ClusterRegisters(gvsoc.systree.Component):
 
-    def __init__(self, parent, name, boot_addr=0, nb_cores=1):
+    def __init__(self, parent, name, boot_addr=0, nb_cores=1, global_barrier=False):
         super(ClusterRegisters, self).__init__(parent, name)
 
         self.add_sources(['pulp/snitch/snitch_cluster/cluster_registers.cpp'])
 
         self.add_properties({
             'boot_addr': boot_addr,
-            'nb_cores': nb_cores
+            'nb_cores': nb_cores,
+            'global_barrier': global_barrier
         })
 
     def gen(self, builddir, installdir):
@@ -48,5 +49,11 @@ class ClusterRegisters(gvsoc.systree.Component):
     def i_BARRIER_ACK(self, core: int) -> gvsoc.systree.SlaveItf:
         return gvsoc.systree.SlaveItf(self, f'barrier_req_{core}', signature='wire<bool>')
 
+    def o_GLOBAL_BARRIER_REQ(self, itf: gvsoc.systree.SlaveItf):
+        self.itf_bind('global_barrier_req', itf, signature='wire<bool>')
+
+    def i_GLOBAL_BARRIER_ACK(self) -> gvsoc.systree.SlaveItf:
+        return gvsoc.systree.SlaveItf(self, 'global_barrier_ack', signature='wire<bool>')
+
     def gen_gui(self, parent_signal):
         return gvsoc.gui.Signal(self, parent_signal, name=self.name, is_group=True, groups=["regmap"])
\ No newline at end of file
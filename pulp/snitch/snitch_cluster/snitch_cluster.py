@@ -44,6 +44,7 @@ class Area:
 class ClusterArch:
     def __init__(self, properties, base, first_hartid):
         self.nb_core = properties.nb_core_per_cluster
+        self.global_barrier = properties.global_barrier
         self.base = base
         self.first_hartid = first_hartid
 
@@ -128,7 +129,8 @@ class SnitchCluster(gvsoc.systree.Component):
             cores_ico.append(router.Router(self, f'pe{core_id}_ico', bandwidth=arch.tcdm.bank_width))
 
         # Cluster peripherals
-        cluster_registers = ClusterRegisters(self, 'cluster_registers', nb_cores=arch.nb_core)
+        cluster_registers = ClusterRegisters(self, 'cluster_registers', nb_cores=arch.nb_core,
+            global_barrier=arch.global_barrier)
 
         # Cluster DMA
         idma = SnitchDma(self, 'idma', loc_base=arch.tcdm.area.base, loc_size=arch.tcdm.area.size,
@@ -170,6 +172,8 @@ class SnitchCluster(gvsoc.systree.Component):
             self.bind(cluster_registers, f'barrier_ack', cores[core_id], 'barrier_ack')
         for core_id in range(0, arch.nb_core):
             cluster_registers.o_EXTERNAL_IRQ(core_id, cores[core_id].i_IRQ(arch.barrier_irq))
+        cluster_registers.o_GLOBAL_BARRIER_REQ(self.i_GLOBAL_BARRIER_REQ())
+        self.o_GLOBAL_BARRIER_ACK(cluster_registers.i_GLOBAL_BARRIER_ACK())
 
         # Cluster DMA
         idma.o_AXI(wide_axi.i_INPUT())
@@ -202,3 +206,15 @@ class SnitchCluster(gvsoc.systree.Component):
 
     def o_NARROW_SOC(self, itf: gvsoc.systree.SlaveItf):
         self.itf_bind('narrow_soc', itf, signature='io')
+
+    def i_GLOBAL_BARRIER_REQ(self) -> gvsoc.systree.SlaveItf:
+        return gvsoc.systree.SlaveItf(self, 'global_barrier_req', signature='wire<bool>')
+
+    def o_GLOBAL_BARRIER_REQ(self, itf: gvsoc.systree.SlaveItf):
+        self.itf_bind('global_barrier_req', itf, signature='wire<bool>')
+
+    def i_GLOBAL_BARRIER_ACK(self) -> gvsoc.systree.SlaveItf:
+        return gvsoc.systree.SlaveItf(self, 'global_barrier_ack', signature='wire<bool>')
+
+    def o_GLOBAL_BARRIER_ACK(self, itf: gvsoc.systree.SlaveItf):
+        self.itf_bind('global_barrier_ack', itf, signature='wire<bool>', composite_bind=True)
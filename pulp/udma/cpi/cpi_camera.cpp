@@ -0,0 +1,350 @@
+/*
+ * Copyright (C) 2024 ETH Zurich and University of Bologna
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <vector>
+#include <string>
+#include <cstring>
+#include <cctype>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <vp/vp.hpp>
+#include <vp/itf/io.hpp>
+
+
+/*
+ * Camera model feeding the frame-level interface of the CPI with frames read from files.
+ * Files are either PGM (P5) or PPM (P6) images, or raw files which already contain the bytes
+ * of the data bus, 2 per pixel. Gray pixels are sent as 16 bits values and color pixels are
+ * converted to RGB565. Each frame is sent line by line, or in one request in frame mode, and
+ * the files are used in order, and looped over if asked.
+ */
+class CpiCamera : public vp::Component
+{
+
+public:
+    CpiCamera(vp::ComponentConf &config);
+
+    void reset(bool active);
+
+private:
+    static void frame_handler(vp::Block *__this, vp::ClockEvent *event);
+    bool open_frame();
+    void close_frame();
+    uint8_t *get_line(int line);
+
+    vp::Trace trace;
+    vp::IoMaster frame_itf;
+    vp::ClockEvent frame_event;
+    vp::IoReq req;
+
+    std::vector<std::string> files;
+    // Configured dimensions, used for raw files
+    int raw_width;
+    int raw_height;
+    // Dimensions of the current frame, which can come from the PGM/PPM header
+    int width;
+    int height;
+    int line_delay;
+    int frame_delay;
+    bool frame_mode;
+    bool loop;
+
+    int current_file;
+    int current_line;
+
+    // Currently mapped file
+    uint8_t *map;
+    size_t map_size;
+    // Pixel data inside the mapped file
+    uint8_t *pixels;
+    // 0 for raw, 1 for gray and 3 for color
+    int nb_components;
+    // Bytes per component
+    int component_size;
+    std::vector<uint8_t> line_buffer;
+    std::vector<uint8_t> frame_buffer;
+};
+
+
+
+CpiCamera::CpiCamera(vp::ComponentConf &config)
+    : vp::Component(config), frame_event(this, &CpiCamera::frame_handler)
+{
+    this->traces.new_trace("trace", &this->trace, vp::DEBUG);
+
+    this->new_master_port("frame", &this->frame_itf);
+
+    for (auto x: this->get_js_config()->get("files")->get_elems())
+    {
+        this->files.push_back(x->get_str());
+    }
+
+    this->raw_width = this->get_js_config()->get("width")->get_int();
+    this->raw_height = this->get_js_config()->get("height")->get_int();
+    this->width = this->raw_width;
+    this->height = this->raw_height;
+    this->line_delay = this->get_js_config()->get("line_delay")->get_int();
+    this->frame_delay = this->get_js_config()->get("frame_delay")->get_int();
+    this->frame_mode = this->get_js_config()->get("frame_mode")->get_bool();
+    this->loop = this->get_js_config()->get("loop")->get_bool();
+
+    this->map = NULL;
+}
+
+
+
+void CpiCamera::reset(bool active)
+{
+    if (active)
+    {
+        this->close_frame();
+        this->current_file = 0;
+        this->current_line = 0;
+    }
+    else
+    {
+        if (this->files.size() > 0)
+        {
+            this->frame_event.enqueue(this->frame_delay ? this->frame_delay : 1);
+        }
+    }
+}
+
+
+
+bool CpiCamera::open_frame()
+{
+    std::string path = this->files[this->current_file];
+
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd == -1)
+    {
+        this->trace.force_warning("Unable to open frame file (path: %s)\n", path.c_str());
+        return false;
+    }
+
+    struct stat st;
+    fstat(fd, &st);
+    this->map_size = st.st_size;
+    this->map = (uint8_t *)mmap(NULL, this->map_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+
+    if (this->map == MAP_FAILED)
+    {
+        this->map = NULL;
+        this->trace.force_warning("Unable to map frame file (path: %s)\n", path.c_str());
+        return false;
+    }
+
+    this->width = this->raw_width;
+    this->height = this->raw_height;
+    this->nb_components = 0;
+    this->component_size = 2;
+    this->pixels = this->map;
+
+    if (this->map_size > 2 && this->map[0] == 'P' && (this->map[1] == '5' || this->map[1] == '6'))
+    {
+        // Header is made of the magic, width, height and max value, separated by whitespaces
+        // and comments, and followed by a single whitespace
+        int fields[3];
+        size_t index = 2;
+        for (int i=0; i<3; i++)
+        {
+            while (index < this->map_size && (isspace(this->map[index]) || this->map[index] == '#'))
+            {
+                if (this->map[index] == '#')
+                {
+                    while (index < this->map_size && this->map[index] != '\n')
+                        index++;
+                }
+                else
+                {
+                    index++;
+                }
+            }
+
+            fields[i] = 0;
+            while (index < this->map_size && isdigit(this->map[index]))
+            {
+                fields[i] = fields[i] * 10 + this->map[index++] - '0';
+            }
+        }
+
+        this->width = fields[0];
+        this->height = fields[1];
+        this->nb_components = this->map[1] == '5' ? 1 : 3;
+        this->component_size = fields[2] > 255 ? 2 : 1;
+        this->pixels = &this->map[index + 1];
+    }
+
+    size_t frame_size = (size_t)this->width * this->height *
+        (this->nb_components ? this->nb_components * this->component_size : 2);
+    if (this->pixels + frame_size > this->map + this->map_size)
+    {
+        this->trace.force_warning("Frame file is too small (path: %s, width: %d, height: %d)\n",
+            path.c_str(), this->width, this->height);
+        this->close_frame();
+        return false;
+    }
+
+    this->line_buffer.resize(this->width * 2);
+
+    this->trace.msg(vp::Trace::LEVEL_INFO, "Opened frame (path: %s, width: %d, height: %d)\n",
+        path.c_str(), this->width, this->height);
+
+    return true;
+}
+
+
+
+void CpiCamera::close_frame()
+{
+    if (this->map)
+    {
+        munmap(this->map, this->map_size);
+        this->map = NULL;
+    }
+}
+
+
+
+uint8_t *CpiCamera::get_line(int line)
+{
+    int width = this->width;
+
+    // Raw and 16 bits gray lines already have the bus layout, MSB first
+    if (this->nb_components == 0 || (this->nb_components == 1 && this->component_size == 2))
+    {
+        return &this->pixels[(size_t)line * width * 2];
+    }
+
+    int pixel_size = this->nb_components * this->component_size;
+    uint8_t *in = &this->pixels[(size_t)line * width * pixel_size];
+    uint8_t *out = this->line_buffer.data();
+
+    if (this->nb_components == 1)
+    {
+        for (int i=0; i<width; i++)
+        {
+            out[2*i] = 0;
+            out[2*i+1] = in[i];
+        }
+    }
+    else
+    {
+        // Only keep the most significant byte of 16 bits components
+        int step = this->component_size;
+        for (int i=0; i<width; i++)
+        {
+            uint32_t r = in[i*pixel_size];
+            uint32_t g = in[i*pixel_size + step];
+            uint32_t b = in[i*pixel_size + 2*step];
+            uint32_t pixel = ((r >> 3) << 11) | ((g >> 2) << 5) | (b >> 3);
+            out[2*i] = pixel >> 8;
+            out[2*i+1] = pixel & 0xff;
+        }
+    }
+
+    return out;
+}
+
+
+
+void CpiCamera::frame_handler(vp::Block *__this, vp::ClockEvent *event)
+{
+    CpiCamera *_this = (CpiCamera *)__this;
+
+    if (_this->current_line == 0)
+    {
+        if (!_this->open_frame())
+        {
+            return;
+        }
+    }
+
+    int nb_lines = _this->frame_mode ? _this->height : 1;
+    int line_size = _this->width * 2;
+    uint8_t *data;
+
+    if (_this->frame_mode)
+    {
+        if (_this->nb_components == 0 || (_this->nb_components == 1 && _this->component_size == 2))
+        {
+            data = _this->pixels;
+        }
+        else
+        {
+            // Convert the whole frame, line by line, into the frame buffer
+            _this->frame_buffer.resize((size_t)line_size * _this->height);
+            for (int i=0; i<_this->height; i++)
+            {
+                memcpy(&_this->frame_buffer[(size_t)i * line_size], _this->get_line(i), line_size);
+            }
+            data = _this->frame_buffer.data();
+        }
+    }
+    else
+    {
+        data = _this->get_line(_this->current_line);
+    }
+
+    _this->trace.msg(vp::Trace::LEVEL_DEBUG, "Sending frame data (file: %d, line: %d, nb_lines: %d)\n",
+        _this->current_file, _this->current_line, nb_lines);
+
+    vp::IoReq *req = &_this->req;
+    req->prepare();
+    req->set_addr((uint64_t)_this->current_line * line_size);
+    req->set_size((uint64_t)nb_lines * line_size);
+    req->set_data(data);
+    req->set_is_write(true);
+
+    if (_this->frame_itf.req(req) != vp::IO_REQ_OK)
+    {
+        _this->trace.fatal("Unsupported asynchronous reply\n");
+    }
+
+    _this->current_line += nb_lines;
+
+    if (_this->current_line < _this->height)
+    {
+        _this->frame_event.enqueue(_this->line_delay ? _this->line_delay : 1);
+        return;
+    }
+
+    _this->close_frame();
+    _this->current_line = 0;
+    _this->current_file++;
+    if (_this->current_file == (int)_this->files.size())
+    {
+        if (!_this->loop)
+        {
+            _this->trace.msg(vp::Trace::LEVEL_INFO, "All frames sent\n");
+            return;
+        }
+        _this->current_file = 0;
+    }
+
+    _this->frame_event.enqueue(_this->frame_delay ? _this->frame_delay : 1);
+}
+
+
+
+extern "C" vp::Component *gv_new(vp::ComponentConf &config)
+{
+    return new CpiCamera(config);
+}
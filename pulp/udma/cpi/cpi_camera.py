@@ -0,0 +1,46 @@
+#
+# Copyright (C) 2024 ETH Zurich and University of Bologna
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+#
+
+import gvsoc.systree
+
+
+class CpiCamera(gvsoc.systree.Component):
+    """Camera model sending frames read from raw, PGM or PPM files to the CPI frame interface.
+
+    Width and height are only used for raw files, PGM and PPM files give their own.
+    Delays are in cycles, between lines and between frames.
+    """
+
+    def __init__(self, parent: gvsoc.systree.Component, name: str, files: list, width: int=0,
+            height: int=0, line_delay: int=1, frame_delay: int=1000, frame_mode: bool=False,
+            loop: bool=False):
+
+        super().__init__(parent, name)
+
+        self.add_sources(['pulp/udma/cpi/cpi_camera.cpp'])
+
+        self.add_properties({
+            'files': files,
+            'width': width,
+            'height': height,
+            'line_delay': line_delay,
+            'frame_delay': frame_delay,
+            'frame_mode': frame_mode,
+            'loop': loop
+        })
+
+    def o_FRAME(self, itf: gvsoc.systree.SlaveItf):
+        self.itf_bind('frame', itf, signature='io')
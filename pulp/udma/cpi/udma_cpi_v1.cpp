@@ -38,6 +38,10 @@ Cpi_periph_v1::Cpi_periph_v1(udma *top, int id, int itf_id) : Udma_periph(top, i
 
   cpi_itf.set_sync_meth(&Cpi_periph_v1::sync);
   cpi_itf.set_sync_cycle_meth(&Cpi_periph_v1::sync_cycle);
+
+  top->new_slave_port(itf_name + "_frame", &frame_itf, (vp::Block *)this);
+
+  frame_itf.set_req_meth(&Cpi_periph_v1::frame_req);
 }
  
 
@@ -184,6 +188,183 @@ void Cpi_periph_v1::push_pixel(uint32_t pixel)
 }
 
 
+/*
+ * Converts a buffer of pixels, as assembled from the data bus, to the output format.
+ * Each output pixel is 2 bytes, as for push_pixel.
+ */
+int Cpi_periph_v1::convert_pixels(uint16_t *pixels, int nb_pixels, uint8_t *out)
+{
+  uint16_t *out_pixels = (uint16_t *)out;
+
+  if (this->format == ARCHI_CAM_CFG_GLOB_FORMAT_BYPASS_LITEND)
+  {
+    memcpy(out, pixels, nb_pixels * 2);
+  }
+  else if (this->format == ARCHI_CAM_CFG_GLOB_FORMAT_BYPASS_BIGEND)
+  {
+    for (int i=0; i<nb_pixels; i++)
+    {
+      out_pixels[i] = (pixels[i] >> 8) | (pixels[i] << 8);
+    }
+  }
+  else
+  {
+    int b_shift = 0, b_size = 0, g_shift = 0, g_size = 0, r_shift = 0, r_size = 0;
+    switch (this->format) {
+      case ARCHI_CAM_CFG_GLOB_FORMAT_RGB565:
+      b_size = 5; g_shift = 5; g_size = 6; r_shift = 11; r_size = 5;
+      break;
+      case ARCHI_CAM_CFG_GLOB_FORMAT_RGB555:
+      b_size = 5; g_shift = 5; g_size = 5; r_shift = 10; r_size = 5;
+      break;
+      case ARCHI_CAM_CFG_GLOB_FORMAT_RGB444:
+      b_size = 4; g_shift = 4; g_size = 4; r_shift = 8; r_size = 4;
+      break;
+    }
+
+    // Fold the left shift of each component into its coefficient so that the loop only has
+    // masks, multiplies and adds
+    uint64_t b_coeff = (uint64_t)this->bCoeff << (8 - b_size);
+    uint64_t g_coeff = (uint64_t)this->gCoeff << (8 - g_size);
+    uint64_t r_coeff = (uint64_t)this->rCoeff << (8 - r_size);
+    uint32_t b_mask = (1 << b_size) - 1;
+    uint32_t g_mask = (1 << g_size) - 1;
+    uint32_t r_mask = (1 << r_size) - 1;
+    unsigned int shift = this->shift;
+
+    for (int i=0; i<nb_pixels; i++)
+    {
+      uint32_t pixel = pixels[i];
+      uint64_t b = (pixel >> b_shift) & b_mask;
+      uint64_t g = (pixel >> g_shift) & g_mask;
+      uint64_t r = (pixel >> r_shift) & r_mask;
+      out_pixels[i] = (b*b_coeff + g*g_coeff + r*r_coeff) >> shift;
+    }
+  }
+
+  return nb_pixels * 2;
+}
+
+
+/*
+ * Frame-level counterpart of push_pixel, which handles a whole buffer of bytes taken from
+ * the data bus and pushes all the resulting pixels at once.
+ */
+void Cpi_periph_v1::push_pixels(uint8_t *data, int size)
+{
+  int nb_pixels = (size + this->has_pending_byte) / 2;
+
+  this->frame_pixels.resize(nb_pixels);
+  this->frame_burst.resize(nb_pixels * 2);
+
+  if (nb_pixels == 0)
+  {
+    this->has_pending_byte = true;
+    this->pending_byte = data[0];
+    return;
+  }
+
+  uint16_t *pixels = this->frame_pixels.data();
+
+  // Pixels are sent MSB first on the bus
+  if (this->has_pending_byte)
+  {
+    pixels[0] = (this->pending_byte << 8) | data[0];
+    data++;
+    size--;
+    pixels++;
+  }
+
+  int nb_bus_pixels = size / 2;
+  for (int i=0; i<nb_bus_pixels; i++)
+  {
+    pixels[i] = (data[2*i] << 8) | data[2*i+1];
+  }
+
+  this->has_pending_byte = size & 1;
+  if (this->has_pending_byte)
+  {
+    this->pending_byte = data[size - 1];
+  }
+
+  pixels = this->frame_pixels.data();
+  uint8_t *burst = this->frame_burst.data();
+  int burst_size = 0;
+
+  if (!this->frameSliceEn)
+  {
+    burst_size = this->convert_pixels(pixels, nb_pixels, burst);
+  }
+  else
+  {
+    // Go through the buffer row segment by row segment and only keep the part of each segment
+    // which is inside the window
+    while (nb_pixels > 0)
+    {
+      int nb_row_pixels = this->rowLen - this->currentRow;
+      if (nb_row_pixels > nb_pixels)
+        nb_row_pixels = nb_pixels;
+
+      if (this->currentLine >= this->frameSliceLly && this->currentLine <= this->frameSliceUry)
+      {
+        int first = (int)this->frameSliceLlx - (int)this->currentRow;
+        int last = (int)this->frameSliceUrx - (int)this->currentRow;
+        if (first < 0)
+          first = 0;
+        if (last > nb_row_pixels - 1)
+          last = nb_row_pixels - 1;
+
+        if (first <= last)
+        {
+          burst_size += this->convert_pixels(&pixels[first], last - first + 1, &burst[burst_size]);
+        }
+      }
+
+      pixels += nb_row_pixels;
+      nb_pixels -= nb_row_pixels;
+      this->currentRow += nb_row_pixels;
+      if (this->currentRow == this->rowLen) {
+        this->currentRow = 0;
+        this->currentLine++;
+      }
+    }
+  }
+
+  this->trace.msg("Pushing pixels (size: %d)\n", burst_size);
+
+  if (burst_size)
+  {
+    (static_cast<Cpi_rx_channel *>(this->channel0))->push_data(burst, burst_size);
+  }
+}
+
+
+/*
+ * Frame-level interface. The request contains bytes as they would be sampled on the data
+ * bus while href is active, and its address is the offset of the first byte in the frame,
+ * so that a request at offset 0 starts a new frame. A source can send the frame in one
+ * request or line by line.
+ */
+vp::IoReqStatus Cpi_periph_v1::frame_req(vp::Block *__this, vp::IoReq *req)
+{
+  Cpi_periph_v1 *_this = (Cpi_periph_v1 *)__this;
+
+  _this->trace.msg("Received frame data (offset: 0x%lx, size: 0x%lx)\n", req->get_addr(), req->get_size());
+
+  if (req->get_addr() == 0)
+  {
+    _this->handle_sof();
+  }
+
+  // To transmit the data, the channel must be enabled with no frame dropping or with the enabled frame
+  if (req->get_size() > 0 && _this->enabled && (!_this->frameDrop || !_this->frameDropCount) && _this->cmd_ready) {
+    _this->push_pixels(req->get_data(), req->get_size());
+  }
+
+  return vp::IO_REQ_OK;
+}
+
+
 void Cpi_periph_v1::sync(vp::Block *__this, int pclk, int href, int vsync, int data)
 {
   Cpi_periph_v1 *_this = (Cpi_periph_v1 *)__this;
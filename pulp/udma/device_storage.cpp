@@ -0,0 +1,195 @@
+/*
+ * Copyright (C) 2024 ETH Zurich and University of Bologna
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <cstring>
+#include <algorithm>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "device_storage.hpp"
+
+
+Device_storage::Device_storage(vp::Trace *trace)
+    : trace(trace), data(NULL), size(0), image_size(0), erased_value(0)
+{
+}
+
+
+
+Device_storage::~Device_storage()
+{
+    if (this->data)
+    {
+        munmap(this->data, this->size);
+    }
+}
+
+
+
+bool Device_storage::open(std::string image, size_t size, uint8_t erased_value)
+{
+    size_t image_size = 0;
+    int fd = -1;
+
+    if (image != "")
+    {
+        fd = ::open(image.c_str(), O_RDONLY);
+        if (fd == -1)
+        {
+            this->trace->force_warning("Unable to open image (path: %s)\n", image.c_str());
+            return false;
+        }
+
+        struct stat st;
+        fstat(fd, &st);
+        image_size = st.st_size;
+
+        if (image_size > size)
+        {
+            this->trace->force_warning("Image is bigger than device, truncating it (path: %s, image_size: 0x%lx, size: 0x%lx)\n",
+                image.c_str(), image_size, size);
+            image_size = size;
+        }
+    }
+
+    this->size = size;
+    this->data = (uint8_t *)mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+    if (this->data == MAP_FAILED)
+    {
+        this->data = NULL;
+        this->trace->force_warning("Unable to allocate device storage (size: 0x%lx)\n", size);
+        if (fd != -1)
+            close(fd);
+        return false;
+    }
+
+    if (image_size > 0)
+    {
+        // Pages of the file are shared with the page cache until they are modified
+        if (mmap(this->data, image_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_FIXED, fd, 0) == MAP_FAILED)
+        {
+            this->trace->force_warning("Unable to map image (path: %s)\n", image.c_str());
+            close(fd);
+            return false;
+        }
+    }
+
+    if (fd != -1)
+        close(fd);
+
+    // Nothing is written here, the rest of the device is erased through the XOR encoding
+    this->image_size = image_size;
+    this->erased_value = erased_value;
+
+    this->trace->msg(vp::Trace::LEVEL_INFO, "Opened device storage (image: %s, image_size: 0x%lx, size: 0x%lx)\n",
+        image.c_str(), image_size, size);
+
+    return true;
+}
+
+
+
+bool Device_storage::check_access(uint64_t offset, size_t size)
+{
+    if (this->data == NULL || offset + size > this->size)
+    {
+        this->trace->force_warning("Out-of-bound device access (offset: 0x%lx, size: 0x%lx, device_size: 0x%lx)\n",
+            offset, size, this->size);
+        return false;
+    }
+    return true;
+}
+
+
+
+void Device_storage::xor_erased(uint8_t *data, uint64_t offset, size_t size)
+{
+    if (this->erased_value == 0 || offset + size <= this->image_size)
+        return;
+
+    size_t start = offset < this->image_size ? this->image_size - offset : 0;
+    for (size_t i=start; i<size; i++)
+    {
+        data[i] ^= this->erased_value;
+    }
+}
+
+
+
+bool Device_storage::read(uint64_t offset, uint8_t *data, size_t size)
+{
+    if (!this->check_access(offset, size))
+        return false;
+
+    memcpy(data, this->data + offset, size);
+    this->xor_erased(data, offset, size);
+    return true;
+}
+
+
+
+bool Device_storage::write(uint64_t offset, uint8_t *data, size_t size)
+{
+    if (!this->check_access(offset, size))
+        return false;
+
+    memcpy(this->data + offset, data, size);
+    this->xor_erased(this->data + offset, offset, size);
+    return true;
+}
+
+
+
+bool Device_storage::fill(uint64_t offset, size_t size, uint8_t value)
+{
+    if (!this->check_access(offset, size))
+        return false;
+
+    // The image part holds plain bytes
+    if (offset < this->image_size)
+    {
+        size_t image_part = std::min(size, (size_t)(this->image_size - offset));
+        memset(this->data + offset, value, image_part);
+        offset += image_part;
+        size -= image_part;
+    }
+
+    if (size == 0)
+        return true;
+
+    uint8_t stored = value ^ this->erased_value;
+
+    // Erasing whole pages past the image gives them back to the system, they are then
+    // zero again, which is the erased value once decoded
+    if (stored == 0)
+    {
+        size_t page_size = sysconf(_SC_PAGESIZE);
+        uint64_t first_page = (offset + page_size - 1) & ~(uint64_t)(page_size - 1);
+        uint64_t last_page = (offset + size) & ~(uint64_t)(page_size - 1);
+
+        if (first_page < last_page)
+        {
+            memset(this->data + offset, 0, first_page - offset);
+            madvise(this->data + first_page, last_page - first_page, MADV_DONTNEED);
+            memset(this->data + last_page, 0, offset + size - last_page);
+            return true;
+        }
+    }
+
+    memset(this->data + offset, stored, size);
+    return true;
+}
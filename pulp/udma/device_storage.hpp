@@ -0,0 +1,60 @@
+/*
+ * Copyright (C) 2024 ETH Zurich and University of Bologna
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef __PULP_UDMA_DEVICE_STORAGE_HPP__
+#define __PULP_UDMA_DEVICE_STORAGE_HPP__
+
+#include <string>
+#include <vp/vp.hpp>
+
+
+/*
+ * Backing store of the external memories connected to the uDMA interfaces.
+ * The whole device is an anonymous private mapping, over which the image file, if any, is
+ * mapped privately, so that opening it does not depend on its size and only the pages which
+ * are modified are copied into process memory. The file itself is never modified.
+ * Beyond the image, bytes are stored XORed with the erased value, so that untouched zero
+ * pages read as erased without being allocated.
+ */
+class Device_storage
+{
+public:
+    Device_storage(vp::Trace *trace);
+    ~Device_storage();
+
+    // Image can be empty, and if it is smaller than the device, the rest is filled with
+    // erased_value
+    bool open(std::string image, size_t size, uint8_t erased_value=0);
+
+    size_t get_size() { return this->size; }
+
+    bool read(uint64_t offset, uint8_t *data, size_t size);
+    bool write(uint64_t offset, uint8_t *data, size_t size);
+    bool fill(uint64_t offset, size_t size, uint8_t value);
+
+private:
+    bool check_access(uint64_t offset, size_t size);
+    void xor_erased(uint8_t *data, uint64_t offset, size_t size);
+
+    vp::Trace *trace;
+    uint8_t *data;
+    size_t size;
+    // Bytes starting from this offset are stored XORed with erased_value
+    size_t image_size;
+    uint8_t erased_value;
+};
+
+#endif
@@ -0,0 +1,111 @@
+/*
+ * Copyright (C) 2024 ETH Zurich and University of Bologna
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <vp/vp.hpp>
+#include <vp/itf/io.hpp>
+#include "../device_storage.hpp"
+
+
+/*
+ * HyperRAM or HyperFlash connected to the transaction-level interface of the Hyper
+ * peripheral (see Hyper_periph_v3). Each request reads or writes a whole transfer at the
+ * request address. Register space accesses are accepted and read as zero. The flash is
+ * read-only, as its programming sequences are not modelled.
+ */
+class HyperMem : public vp::Component
+{
+
+public:
+    HyperMem(vp::ComponentConf &config);
+
+private:
+    static vp::IoReqStatus req(vp::Block *__this, vp::IoReq *req);
+
+    vp::Trace trace;
+    vp::IoSlave input_itf;
+
+    bool is_flash;
+    Device_storage storage;
+};
+
+
+
+HyperMem::HyperMem(vp::ComponentConf &config)
+    : vp::Component(config), storage(&this->trace)
+{
+    this->traces.new_trace("trace", &this->trace, vp::DEBUG);
+    this->input_itf.set_req_meth(&HyperMem::req);
+
+    this->new_slave_port("input", &this->input_itf);
+
+    size_t size = this->get_js_config()->get("size")->get_int();
+    std::string image = this->get_js_config()->get("image")->get_str();
+    this->is_flash = this->get_js_config()->get("is_flash")->get_bool();
+
+    this->storage.open(image, size, this->is_flash ? 0xff : 0);
+}
+
+
+
+vp::IoReqStatus HyperMem::req(vp::Block *__this, vp::IoReq *req)
+{
+    HyperMem *_this = (HyperMem *)__this;
+
+    uint64_t offset = req->get_addr();
+    uint8_t *data = req->get_data();
+    uint64_t size = req->get_size();
+    bool is_write = req->get_is_write();
+    bool is_register = *(uint32_t *)req->arg_get(1);
+
+    _this->trace.msg(vp::Trace::LEVEL_DEBUG, "Received transaction (offset: 0x%lx, size: 0x%lx, is_write: %d, register: %d)\n",
+        offset, size, is_write, is_register);
+
+    if (is_register)
+    {
+        if (!is_write)
+        {
+            memset(data, 0, size);
+        }
+        return vp::IO_REQ_OK;
+    }
+
+    // Out-of-bound accesses are reported by the storage
+    if (is_write)
+    {
+        if (_this->is_flash)
+        {
+            _this->trace.force_warning("Ignoring write to flash (offset: 0x%lx, size: 0x%lx)\n",
+                offset, size);
+        }
+        else
+        {
+            _this->storage.write(offset, data, size);
+        }
+    }
+    else
+    {
+        _this->storage.read(offset, data, size);
+    }
+
+    return vp::IO_REQ_OK;
+}
+
+
+
+extern "C" vp::Component *gv_new(vp::ComponentConf &config)
+{
+    return new HyperMem(config);
+}
@@ -0,0 +1,41 @@
+#
+# Copyright (C) 2024 ETH Zurich and University of Bologna
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+#
+
+import gvsoc.systree
+
+
+class HyperMem(gvsoc.systree.Component):
+    """HyperRAM or HyperFlash for the Hyper transaction-level interface, backed by a
+    memory-mapped image."""
+
+    def __init__(self, parent: gvsoc.systree.Component, name: str, size: int, image: str='',
+            is_flash: bool=False):
+
+        super().__init__(parent, name)
+
+        self.add_sources([
+            'pulp/udma/hyper/hyper_mem.cpp',
+            'pulp/udma/device_storage.cpp',
+        ])
+
+        self.add_properties({
+            'size': size,
+            'image': image,
+            'is_flash': is_flash
+        })
+
+    def i_INPUT(self) -> gvsoc.systree.SlaveItf:
+        return gvsoc.systree.SlaveItf(self, 'input', signature='io')
@@ -67,6 +67,12 @@ Hyper_periph_v3::Hyper_periph_v3(udma *top, int id, int itf_id) : Udma_periph(to
 
   this->cfg_setup = new bool[HYPER_NB_CHANNELS]{false};
   this->command_word = new bool[HYPER_NB_CHANNELS]{false};
+
+  top->new_master_port(itf_name + "_tlm", &this->tlm_itf, (vp::Block *)this);
+  this->tlm_req = new vp::IoReq();
+  for (int i=0; i<3; i++)
+    this->tlm_req->arg_alloc();
+  this->tlm_end_event = top->event_new((vp::Block *)this, Hyper_periph_v3::handle_tlm_end);
 }
  
 
@@ -87,6 +93,8 @@ void Hyper_periph_v3::reset(bool active)
     this->ending = false;
     this->command_mode = false;
     this->twd_count = 0;
+    this->tlm_busy = false;
+    this->tlm_buffer.clear();
   }
 }
 
@@ -200,28 +208,7 @@ void Hyper_periph_v3::handle_pending_word(vp::Block *__this, vp::ClockEvent *eve
     cs = _this->mem_sel;
     cs_value = 0;
 
-    /* Nothing will be fetched until the whole 2d transaction is completed */
-    if(_this->twd_count)
-    {
-      _this->transfer_splitter();
-    }
-    else
-    {
-      if(_this->get_nb_tran(_this->channel_id) == 0)
-      {
-        _this->set_busy_reg(_this->channel_id, 0);
-        _this->common_regs[(TRANS_ID_ALLOC_OFFSET)/4] = _this->update_trans_id_alloc();
-        _this->trace.msg("Current transfer is finished\n");
-        if (!_this->ca.read)
-        {
-          _this->top->trigger_event(ARCHI_SOC_EVENT_HYPER_EOT_TX);
-        }
-        else
-        {
-          _this->top->trigger_event(ARCHI_SOC_EVENT_HYPER_EOT_RX);
-        }
-      }
-    }
+    _this->handle_transfer_end(_this->ca.read);
     _this->ending = false;
   }
 
@@ -274,8 +261,41 @@ void Hyper_periph_v3::handle_pending_word(vp::Block *__this, vp::ClockEvent *eve
 
 }
 
+/* Called when the chip select is released at the end of a 1D transfer */
+void Hyper_periph_v3::handle_transfer_end(bool read)
+{
+  /* Nothing will be fetched until the whole 2d transaction is completed */
+  if(this->twd_count)
+  {
+    this->transfer_splitter();
+  }
+  else
+  {
+    if(this->get_nb_tran(this->channel_id) == 0)
+    {
+      this->set_busy_reg(this->channel_id, 0);
+      this->common_regs[(TRANS_ID_ALLOC_OFFSET)/4] = this->update_trans_id_alloc();
+      this->trace.msg("Current transfer is finished\n");
+      if (!read)
+      {
+        this->top->trigger_event(ARCHI_SOC_EVENT_HYPER_EOT_TX);
+      }
+      else
+      {
+        this->top->trigger_event(ARCHI_SOC_EVENT_HYPER_EOT_RX);
+      }
+    }
+  }
+}
+
 void Hyper_periph_v3::check_state()
 {
+  if (this->tlm_active())
+  {
+    this->tlm_check_state();
+    return;
+  }
+
   if (this->pending_bytes == 0 && !this->ending)
   {
     /* If transaction is resetted, a new transaction is fetched */
@@ -321,6 +341,113 @@ void Hyper_periph_v3::handle_ready_reqs()
   this->check_state();
 }
 
+
+void Hyper_periph_v3::tlm_check_state()
+{
+  if (this->tlm_busy)
+    return;
+
+  /* If transaction is resetted, a new transaction is fetched */
+  if (this->current_command == NULL)
+  {
+    this->fetch_from_fifos();
+    if (this->current_command == NULL)
+      return;
+  }
+
+  if (this->command_mode)
+  {
+    /* Command mode writes just an half-word */
+    this->pending_bytes = 0;
+    this->tlm_buffer.resize(2);
+    memcpy(this->tlm_buffer.data(), &this->pending_word, 2);
+    this->tlm_transfer(true, 2);
+  }
+  else if (this->current_command->is_write)
+  {
+    /* Gather the whole transfer from the words read from L2 before sending it */
+    int size = this->current_command->size;
+    while (!this->tx_channel->ready_reqs->is_empty() && (int)this->tlm_buffer.size() < size)
+    {
+      vp::IoReq *req = this->tx_channel->ready_reqs->pop();
+      int req_size = req->get_size();
+      if (req_size > size - (int)this->tlm_buffer.size())
+        req_size = size - this->tlm_buffer.size();
+      this->tlm_buffer.insert(this->tlm_buffer.end(), req->get_data(), req->get_data() + req_size);
+      this->tx_channel->handle_ready_req_end(req);
+    }
+
+    if (!this->tlm_busy && (int)this->tlm_buffer.size() == size)
+    {
+      this->tlm_transfer(true, size);
+    }
+  }
+  else if (this->rx_channel->current_cmd)
+  {
+    this->tlm_buffer.resize(this->current_command->size);
+    this->tlm_transfer(false, this->current_command->size);
+  }
+}
+
+
+void Hyper_periph_v3::tlm_transfer(bool is_write, int size)
+{
+  vp::IoReq *req = this->tlm_req;
+
+  this->set_device(this->current_command->mem_sel);
+
+  req->prepare();
+  req->set_addr(this->current_command->ex_addr);
+  req->set_size(size);
+  req->set_data(this->tlm_buffer.data());
+  req->set_is_write(is_write);
+  *(uint32_t *)req->arg_get(0) = this->mem_sel;
+  *(uint32_t *)req->arg_get(1) = ARCHI_REG_FIELD_GET(this->current_command->ca_setup, 1, 1);
+  *(uint32_t *)req->arg_get(2) = ARCHI_REG_FIELD_GET(this->current_command->ca_setup, 0, 1);
+
+  this->trace.msg(vp::Trace::LEVEL_DEBUG, "%d: Sending HYPER transaction (addr: 0x%x, size: %d, is_write: %d, cs: %d)\n",
+    this->channel_id, this->current_command->ex_addr, size, is_write, this->mem_sel);
+
+  if (this->tlm_itf.req(req) != vp::IO_REQ_OK)
+  {
+    this->trace.force_warning("Asynchronous HYPER transactions are not supported\n");
+  }
+
+  int64_t delay = this->current_command->latency << this->current_command->en_add_latency;
+  int64_t latency = delay + (size + 8) * (this->clkdiv ? this->clkdiv : 1) + req->get_latency();
+
+  this->tlm_busy = true;
+  this->tlm_is_write = is_write;
+  this->top->get_periph_clock()->enqueue_ext(this->tlm_end_event, latency > 0 ? latency : 1);
+}
+
+
+void Hyper_periph_v3::handle_tlm_end(vp::Block *__this, vp::ClockEvent *event)
+{
+  Hyper_periph_v3 *_this = (Hyper_periph_v3 *)__this;
+
+  _this->trace.msg(vp::Trace::LEVEL_DEBUG, "%d: HYPER transaction done\n", _this->channel_id);
+
+  if (!_this->tlm_is_write)
+  {
+    _this->rx_channel->push_data(_this->tlm_buffer.data(), _this->tlm_buffer.size());
+  }
+  _this->tlm_buffer.clear();
+  _this->tlm_busy = false;
+
+  /* Transaction is resetted only when whole 2d transfer is completed */
+  if(_this->twd_count == 0)
+  {
+    _this->free_fifo[_this->channel_id]->push(_this->current_command);
+    _this->current_command = NULL;
+    _this->update_nb_tran(_this->channel_id, -1);
+  }
+
+  _this->handle_transfer_end(!_this->tlm_is_write);
+
+  _this->check_state();
+}
+
 /* Fetches from channels fifos the transaction and enqueues request to uDMA */
 void Hyper_periph_v3::fetch_from_fifos()
 {
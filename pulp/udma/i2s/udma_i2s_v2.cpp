@@ -42,6 +42,13 @@ I2s_periph::I2s_periph(udma *top, int id, int itf_id) : Udma_periph(top, id)
   this->ch_itf[0].set_sync_meth_muxed(&I2s_periph::rx_sync, 0);
   this->ch_itf[1].set_sync_meth_muxed(&I2s_periph::rx_sync, 1);
 
+  // Block mode, the source sends packed bits instead of driving the pads
+  top->new_slave_port("i2s" + std::to_string(itf_id*2) + "_block", &this->block_itf[0], (vp::Block *)this);
+  top->new_slave_port("i2s" + std::to_string(itf_id*2+1) + "_block", &this->block_itf[1], (vp::Block *)this);
+
+  this->block_itf[0].set_req_meth_muxed(&I2s_periph::rx_block_req, 0);
+  this->block_itf[1].set_req_meth_muxed(&I2s_periph::rx_block_req, 1);
+
   this->top->new_reg(itf_name + "i2s_clkcfg_setup", &this->r_i2s_clkcfg_setup, 0);
   this->top->new_reg(itf_name + "i2s_slv_setup", &this->r_i2s_slv_setup, 0);
   this->top->new_reg(itf_name + "i2s_mst_setup", &this->r_i2s_mst_setup, 0);
@@ -332,6 +339,27 @@ void I2s_periph::rx_sync(vp::Block *__this, int sck, int ws, int sd, bool full_d
 
 
 
+/*
+ * In block mode, the source sends a whole block of bits in one request instead of one sync per
+ * SCK edge. Bits are packed in the order they are sampled, starting with the LSB of the first
+ * byte. In DDR mode, even bits are sampled on the falling edge and odd bits on the rising edge.
+ */
+vp::IoReqStatus I2s_periph::rx_block_req(vp::Block *__this, vp::IoReq *req, int channel)
+{
+  I2s_periph *_this = (I2s_periph *)__this;
+
+  _this->trace.msg("Received data block (channel: %d, size: %d)\n", channel, req->get_size());
+
+  if (channel == 0)
+    (static_cast<I2s_rx_channel *>(_this->channel0))->handle_rx_block(req->get_data(), req->get_size() * 8);
+  else
+    (static_cast<I2s_rx_channel *>(_this->channel1))->handle_rx_block(req->get_data(), req->get_size() * 8);
+
+  return vp::IO_REQ_OK;
+}
+
+
+
 I2s_rx_channel::I2s_rx_channel(udma *top, I2s_periph *periph, int id, int event_id, string name) : Udma_rx_channel(top, event_id, name), periph(periph), id(id)
 {
   for (int i=0; i<2; i++)
@@ -441,6 +469,124 @@ bool I2s_cic_filter::handle_bit(int din, int pdm_decimation, int pdm_shift, uint
 
 
 
+/*
+ * Same filter as handle_bit, but over a block of bits taken every step bits from first_bit.
+ * The filter state stays in locals during the integrator loop and the comb only runs on
+ * decimated samples. Returns the number of samples written to dout.
+ */
+int I2s_cic_filter::handle_block(uint8_t *data, int first_bit, int nb_bits, int step, int pdm_decimation,
+  int pdm_shift, uint32_t *dout)
+{
+  int64_t y1 = this->pdm_y1_old;
+  int64_t y2 = this->pdm_y2_old;
+  int64_t y3 = this->pdm_y3_old;
+  int64_t y4 = this->pdm_y4_old;
+  int64_t y5 = this->pdm_y5_old;
+  int pending_bits = this->pdm_pending_bits;
+  int nb_samples = 0;
+
+  for (int i=first_bit; i<nb_bits; i+=step)
+  {
+    int64_t value = ((data[i >> 3] >> (i & 7)) & 1) ? 1 : -1;
+
+    // Each stage takes the previous value of the stage before, so update from the last one
+    y5 += y4;
+    y4 += y3;
+    y3 += y2;
+    y2 += y1;
+    y1 += value;
+
+    pending_bits++;
+    if (pending_bits == pdm_decimation)
+    {
+      pending_bits = 0;
+
+      int64_t z1 = y5         - this->pdm_zin1_old;
+      int64_t z2 = this->pdm_z1_old - this->pdm_zin2_old;
+      int64_t z3 = this->pdm_z2_old - this->pdm_zin3_old;
+      int64_t z4 = this->pdm_z3_old - this->pdm_zin4_old;
+      int64_t z5 = this->pdm_z4_old - this->pdm_zin5_old;
+
+      this->pdm_zin1_old = y5;
+      this->pdm_zin2_old = this->pdm_z1_old;
+      this->pdm_zin3_old = this->pdm_z2_old;
+      this->pdm_zin4_old = this->pdm_z3_old;
+      this->pdm_zin5_old = this->pdm_z4_old;
+
+      this->pdm_z1_old = z1;
+      this->pdm_z2_old = z2;
+      this->pdm_z3_old = z3;
+      this->pdm_z4_old = z4;
+      this->pdm_z5_old = z5;
+
+      dout[nb_samples++] = z5 >> pdm_shift;
+    }
+  }
+
+  this->pdm_y1_old = y1;
+  this->pdm_y2_old = y2;
+  this->pdm_y3_old = y3;
+  this->pdm_y4_old = y4;
+  this->pdm_y5_old = y5;
+  this->pdm_pending_bits = pending_bits;
+
+  return nb_samples;
+}
+
+
+
+void I2s_rx_channel::handle_rx_block(uint8_t *data, int nb_bits)
+{
+  int pdm = this->periph->r_i2s_pdm_setup.pdm_en_get();
+  int ddr = this->periph->r_i2s_pdm_setup.pdm_mode_get() == 1 || this->periph->r_i2s_pdm_setup.pdm_mode_get() == 3;
+
+  if (!pdm)
+  {
+    // Standard I2S samples are short, just go through the bit-level path
+    for (int i=0; i<nb_bits; i++)
+    {
+      this->handle_rx_bit(ddr ? i & 1 : 0, 0, (data[i >> 3] >> (i & 7)) & 1);
+    }
+    return;
+  }
+
+  int decimation = this->periph->r_i2s_pdm_setup.pdm_decimation_get() + 1;
+  int shift = (7 - this->periph->r_i2s_pdm_setup.pdm_shift_get())*5;
+  int width = this->periph->r_i2s_slv_setup.slave_bits_get() + 1;
+  int bytes = width <= 8 ? 1 : width <= 16 ? 2 : 4;
+  int nb_filters = ddr ? 2 : 1;
+  int nb_samples = 0;
+
+  for (int i=0; i<nb_filters; i++)
+  {
+    this->block_samples[i].resize(nb_bits / decimation + 1);
+    nb_samples = this->filters[i]->handle_block(data, i, nb_bits, nb_filters, decimation, shift,
+      this->block_samples[i].data());
+  }
+
+  // Blocks are made of bytes so both DDR filters always see the same number of bits and
+  // produce their samples together. Interleave them as they would be on the bit-level path
+  // and push all of them at once.
+  this->block_burst.resize(nb_samples * nb_filters * bytes);
+  uint8_t *burst = this->block_burst.data();
+  for (int i=0; i<nb_samples; i++)
+  {
+    for (int j=0; j<nb_filters; j++)
+    {
+      uint32_t result = this->block_samples[j][i] & ((1<<width)-1);
+      memcpy(burst, &result, bytes);
+      burst += bytes;
+    }
+  }
+
+  if (nb_samples)
+  {
+    ((I2s_rx_channel *)this->periph->channel0)->push_data(this->block_burst.data(), this->block_burst.size());
+  }
+}
+
+
+
 void I2s_rx_channel::handle_rx_bit(int sck, int ws, int bit)
 {
   int pdm = this->periph->r_i2s_pdm_setup.pdm_en_get();
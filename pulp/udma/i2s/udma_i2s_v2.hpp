@@ -22,6 +22,7 @@
 #ifndef __PULP_UDMA_I2S_UDMA_I2S_V2_HPP__
 #define __PULP_UDMA_I2S_UDMA_I2S_V2_HPP__
 
+#include <vector>
 #include <vp/vp.hpp>
 #include "../udma_impl.hpp"
 #include "../archi/udma_i2s_v2.h"
@@ -40,6 +41,8 @@ public:
   I2s_cic_filter();
 
   bool handle_bit(int din, int pdm_decimation, int pdm_shift, uint32_t *dout);
+  int handle_block(uint8_t *data, int first_bit, int nb_bits, int step, int pdm_decimation,
+    int pdm_shift, uint32_t *dout);
   void reset();
 
   int     pdm_pending_bits;
@@ -65,6 +68,7 @@ class I2s_rx_channel : public Udma_rx_channel
 public:
   I2s_rx_channel(udma *top, I2s_periph *periph, int id, int event_id, string name);
   void handle_rx_bit(int sck, int ws, int bit);
+  void handle_rx_block(uint8_t *data, int nb_bits);
 
 private:
   void reset(bool active);
@@ -74,6 +78,8 @@ private:
   int id;
   uint32_t pending_samples[2];
   int pending_bits[2];
+  std::vector<uint32_t> block_samples[2];
+  std::vector<uint8_t> block_burst;
 };
 
 class I2s_periph : public Udma_periph
@@ -87,6 +93,7 @@ public:
 
 protected:
   static void rx_sync(vp::Block *, int sck, int ws, int sd, bool full_duplex,  int channel);
+  static vp::IoReqStatus rx_block_req(vp::Block *, vp::IoReq *req, int channel);
 
 private:
 
@@ -104,6 +111,7 @@ private:
 
   vp::Trace     trace;
   vp::I2sSlave ch_itf[2];
+  vp::IoSlave block_itf[2];
 
   vp_udma_i2s_i2s_clkcfg_setup  r_i2s_clkcfg_setup;
   vp_udma_i2s_i2s_slv_setup     r_i2s_slv_setup;
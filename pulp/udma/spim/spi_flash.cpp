@@ -0,0 +1,180 @@
+/*
+ * Copyright (C) 2024 ETH Zurich and University of Bologna
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ *     http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include <vp/vp.hpp>
+#include <vp/itf/io.hpp>
+#include "../device_storage.hpp"
+
+
+/*
+ * SPI flash connected to the transaction-level interface of the SPIM (see Spim_periph_v3).
+ * Each transaction starts with the command byte and the address, followed by the data to
+ * program, or by the room for the data to read. The command set is the usual one for read,
+ * page program, erase and status, with 3 bytes addresses, or 4 bytes with the dedicated
+ * commands. Program and erase are instantaneous and the device is always ready.
+ */
+class SpiFlash : public vp::Component
+{
+
+public:
+    SpiFlash(vp::ComponentConf &config);
+
+private:
+    static vp::IoReqStatus req(vp::Block *__this, vp::IoReq *req);
+    void program(uint64_t addr, uint8_t *data, int size);
+    void erase(uint64_t addr, size_t size);
+
+    vp::Trace trace;
+    vp::IoSlave input_itf;
+
+    Device_storage storage;
+};
+
+
+
+SpiFlash::SpiFlash(vp::ComponentConf &config)
+    : vp::Component(config), storage(&this->trace)
+{
+    this->traces.new_trace("trace", &this->trace, vp::DEBUG);
+    this->input_itf.set_req_meth(&SpiFlash::req);
+
+    this->new_slave_port("input", &this->input_itf);
+
+    size_t size = this->get_js_config()->get("size")->get_int();
+    std::string image = this->get_js_config()->get("image")->get_str();
+
+    this->storage.open(image, size, 0xff);
+}
+
+
+
+void SpiFlash::program(uint64_t addr, uint8_t *data, int size)
+{
+    // Programming can only clear bits and wraps around the 256 bytes page
+    for (int i=0; i<size; i++)
+    {
+        uint64_t offset = (addr & ~0xffULL) | ((addr + i) & 0xff);
+        uint8_t value;
+        if (offset < this->storage.get_size() && this->storage.read(offset, &value, 1))
+        {
+            value &= data[i];
+            this->storage.write(offset, &value, 1);
+        }
+    }
+}
+
+
+
+void SpiFlash::erase(uint64_t addr, size_t size)
+{
+    addr &= ~(uint64_t)(size - 1);
+    if (addr >= this->storage.get_size())
+    {
+        return;
+    }
+    if (addr + size > this->storage.get_size())
+    {
+        size = this->storage.get_size() - addr;
+    }
+    this->storage.fill(addr, size, 0xff);
+}
+
+
+
+vp::IoReqStatus SpiFlash::req(vp::Block *__this, vp::IoReq *req)
+{
+    SpiFlash *_this = (SpiFlash *)__this;
+
+    uint8_t *data = req->get_data();
+    int tx_bits = *(uint32_t *)req->arg_get(0);
+    int rx_bits = *(uint32_t *)req->arg_get(1);
+    int tx_bytes = (tx_bits + 7) / 8;
+    int rx_bytes = (rx_bits + 7) / 8;
+    uint8_t *rx_data = &data[tx_bytes];
+
+    if (tx_bytes == 0)
+    {
+        return vp::IO_REQ_OK;
+    }
+
+    uint8_t cmd = data[0];
+    int addr_size = 3;
+    switch (cmd)
+    {
+        case 0x13: case 0x0C: case 0x3C: case 0x6C: case 0xBC: case 0xEC:
+        case 0x12: case 0x34: case 0x21: case 0xDC:
+            addr_size = 4;
+            break;
+    }
+
+    uint64_t addr = 0;
+    for (int i=0; i<addr_size && i+1<tx_bytes; i++)
+    {
+        addr = (addr << 8) | data[i+1];
+    }
+
+    _this->trace.msg(vp::Trace::LEVEL_DEBUG, "Received transaction (cmd: 0x%x, addr: 0x%lx, tx_bits: %d, rx_bits: %d)\n",
+        cmd, addr, tx_bits, rx_bits);
+
+    memset(rx_data, 0, rx_bytes);
+
+    switch (cmd)
+    {
+        // Reads, with single, dual or quad data and address
+        case 0x03: case 0x0B: case 0x3B: case 0x6B: case 0xBB: case 0xEB:
+        case 0x13: case 0x0C: case 0x3C: case 0x6C: case 0xBC: case 0xEC:
+            _this->storage.read(addr, rx_data, rx_bytes);
+            break;
+
+        // Page program
+        case 0x02: case 0x32: case 0x12: case 0x34:
+            _this->program(addr, &data[1 + addr_size], tx_bytes - 1 - addr_size);
+            break;
+
+        case 0x20: case 0x21:
+            _this->erase(addr, 4*1024);
+            break;
+
+        case 0x52:
+            _this->erase(addr, 32*1024);
+            break;
+
+        case 0xD8: case 0xDC:
+            _this->erase(addr, 64*1024);
+            break;
+
+        case 0x60: case 0xC7:
+            _this->storage.fill(0, _this->storage.get_size(), 0xff);
+            break;
+
+        // Write enable/disable and status registers, the device is always ready
+        case 0x06: case 0x04: case 0x05: case 0x35: case 0x70:
+            break;
+
+        default:
+            _this->trace.force_warning("Unsupported command (cmd: 0x%x)\n", cmd);
+            break;
+    }
+
+    return vp::IO_REQ_OK;
+}
+
+
+
+extern "C" vp::Component *gv_new(vp::ComponentConf &config)
+{
+    return new SpiFlash(config);
+}
@@ -48,6 +48,12 @@ Spim_periph_v3::Spim_periph_v3(udma *top, int id, int itf_id) : Udma_periph(top,
 
 
   pending_spi_word_event = top->event_new((vp::Block *)this, Spim_periph_v3::handle_spi_pending_word);
+
+  top->new_master_port(itf_name + "_tlm", &tlm_itf, (vp::Block *)this);
+  this->tlm_req = new vp::IoReq();
+  for (int i=0; i<4; i++)
+    this->tlm_req->arg_alloc();
+  this->tlm_end_event = top->event_new((vp::Block *)this, Spim_periph_v3::handle_tlm_end);
 }
 
 void Spim_periph_v3::reset(bool active)
@@ -69,7 +75,146 @@ void Spim_periph_v3::reset(bool active)
     this->next_bit_cycle = -1;
     this->spi_tx_pending_bits = 0;
     this->tx_pending_bits = 0;
+    this->tlm_buffer.clear();
+    this->tlm_tx_bits = 0;
+    this->tlm_dummy_cycles = 0;
+    this->tlm_cycles = 0;
+    this->tlm_rx_words.clear();
+  }
+}
+
+
+void Spim_periph_v3::tlm_push_tx(uint32_t value, int nb_bits, int qpi, int lsb_first, int bitsword, int wordtrans)
+{
+  // Serialize the bits in the same order as the bit-level path puts them on the pads
+  int step = qpi ? 4 : 1;
+  int offset = 0;
+  int counter = 0;
+  int transf = 0;
+
+  for (int i=0; i<nb_bits; i+=step)
+  {
+    int bit_index = lsb_first ? offset + counter : offset + bitsword - counter;
+    int shift = qpi && !lsb_first ? bit_index - 3 : bit_index;
+    unsigned int bits = ARCHI_REG_FIELD_GET(value, shift, step);
+
+    for (int j=step-1; j>=0; j--)
+    {
+      if ((this->tlm_tx_bits & 7) == 0)
+        this->tlm_buffer.push_back(0);
+      this->tlm_buffer.back() |= ((bits >> j) & 1) << (7 - (this->tlm_tx_bits & 7));
+      this->tlm_tx_bits++;
+    }
+
+    this->tlm_cycles++;
+    counter += step;
+    if (counter == bitsword + 1)
+    {
+      counter = 0;
+      offset += wordtrans == 0 ? 0 : wordtrans == 1 ? 16 : 8;
+      transf++;
+      if (transf == 1<<wordtrans)
+      {
+        transf = 0;
+        offset = 0;
+      }
+    }
+  }
+}
+
+
+void Spim_periph_v3::tlm_transfer(int rx_bits)
+{
+  int tx_bytes = this->tlm_buffer.size();
+  int rx_bytes = (rx_bits + 7) / 8;
+  int step = this->spi_qpi ? 4 : 1;
+  vp::IoReq *req = this->tlm_req;
+
+  this->tlm_buffer.resize(tx_bytes + rx_bytes);
+
+  req->prepare();
+  req->set_addr(0);
+  req->set_size(tx_bytes + rx_bytes);
+  req->set_data(this->tlm_buffer.data());
+  req->set_is_write(rx_bits == 0);
+  *(uint32_t *)req->arg_get(0) = this->tlm_tx_bits;
+  *(uint32_t *)req->arg_get(1) = rx_bits;
+  *(uint32_t *)req->arg_get(2) = this->tlm_dummy_cycles;
+  *(uint32_t *)req->arg_get(3) = this->tlm_cs;
+
+  this->trace.msg(vp::Trace::LEVEL_DEBUG, "Sending SPI transaction (tx_bits: %d, rx_bits: %d, dummy: %d, cs: %d)\n",
+    this->tlm_tx_bits, rx_bits, this->tlm_dummy_cycles, this->tlm_cs);
+
+  if (this->tlm_itf.req(req) != vp::IO_REQ_OK)
+  {
+    this->trace.force_warning("Asynchronous SPI transactions are not supported\n");
+  }
+
+  // Rebuild the words from the received bytes with the same bit placement as the
+  // bit-level path
+  uint8_t *rx_data = &this->tlm_buffer[tx_bytes];
+  uint32_t word = 0x57575757;
+  int offset = 0;
+  int counter = 0;
+  int transf = 0;
+  for (int i=0; i<rx_bits; i+=step)
+  {
+    unsigned int bits = 0;
+    for (int j=0; j<step; j++)
+    {
+      bits = (bits << 1) | ((rx_data[(i + j) / 8] >> (7 - ((i + j) & 7))) & 1);
+    }
+
+    int bit_index = this->spi_lsb_first ? offset + counter : offset + this->spi_bitsword - counter;
+    int shift = this->spi_qpi && !this->spi_lsb_first ? bit_index - 3 : bit_index;
+    uint32_t mask = (1 << step) - 1;
+    word = (word & ~(mask << shift)) | ((bits & mask) << shift);
+
+    this->tlm_cycles++;
+    counter += step;
+    if (counter == this->spi_bitsword + 1)
+    {
+      counter = 0;
+      offset += this->spi_wordtrans == 0 ? 0 : this->spi_wordtrans == 1 ? 16 : 8;
+      transf++;
+      if (transf == 1<<this->spi_wordtrans)
+      {
+        this->tlm_rx_words.push_back(word);
+        transf = 0;
+        offset = 0;
+        word = 0x57575757;
+      }
+    }
+  }
+
+  int64_t latency = (this->tlm_cycles + this->tlm_dummy_cycles) * (this->clkdiv ? this->clkdiv : 1) + req->get_latency();
+
+  this->tlm_buffer.clear();
+  this->tlm_tx_bits = 0;
+  this->tlm_dummy_cycles = 0;
+  this->tlm_cycles = 0;
+
+  top->event_enqueue(this->tlm_end_event, latency > 0 ? latency : 1);
+}
+
+
+void Spim_periph_v3::handle_tlm_end(vp::Block *__this, vp::ClockEvent *event)
+{
+  Spim_periph_v3 *_this = (Spim_periph_v3 *)__this;
+
+  _this->trace.msg(vp::Trace::LEVEL_DEBUG, "SPI transaction done\n");
+
+  for (uint32_t word: _this->tlm_rx_words)
+  {
+    (static_cast<Spim_v3_rx_channel *>(_this->channel0))->push_data((uint8_t *)&word, 4);
   }
+  _this->tlm_rx_words.clear();
+
+  _this->waiting_rx = false;
+  _this->waiting_tx_flush = false;
+  _this->channel1->handle_ready_reqs();
+  _this->channel2->handle_ready_reqs();
+  _this->check_state();
 }
 
   
@@ -374,7 +519,7 @@ void Spim_v3_cmd_channel::handle_pending_word(vp::Block *__this, vp::ClockEvent
 
 void Spim_v3_cmd_channel::handle_eot(bool cs_keep)
 {
-  if (!cs_keep)
+  if (!cs_keep && !periph->tlm_active())
   {
     if (!periph->qspim_itf.is_bound())
       periph->trace.force_warning("Trying to set chip select to unbound QSPIM interface\n");
@@ -403,6 +548,12 @@ bool Spim_periph_v3::push_rx_to_spi(int nb_bits, int qpi, int lsb_first, int bit
     this->spi_wordtrans = this->wordtrans;
     this->spi_rx_pending_bits = nb_bits;
 
+    if (this->tlm_active())
+    {
+      this->spi_rx_pending_bits = 0;
+      this->tlm_transfer(nb_bits);
+    }
+
     return true;
   }
   return false;
@@ -410,6 +561,16 @@ bool Spim_periph_v3::push_rx_to_spi(int nb_bits, int qpi, int lsb_first, int bit
 
 bool Spim_periph_v3::push_tx_to_spi(uint32_t value, int nb_bits, int qpi, int lsb_first, int bitsword, int wordtrans)
 {
+  if (this->tlm_active())
+  {
+    this->tlm_push_tx(value, nb_bits, qpi, lsb_first, bitsword, wordtrans);
+    this->qpi = qpi;
+    this->lsb_first = lsb_first;
+    this->bitsword = bitsword;
+    this->wordtrans = wordtrans;
+    return true;
+  }
+
   if (this->spi_tx_pending_bits == 0)
   {
     this->top->get_trace()->msg("Forwarding data to output buffer (nb_bits: %d, value: 0x%x, qpi: %d, lsb_first: %d, bitsword: %d, wordtrans: %d)\n", nb_bits, value, qpi, lsb_first, bitsword, wordtrans);
@@ -464,7 +625,15 @@ void Spim_v3_cmd_channel::handle_data(uint32_t data)
     case SPI_CMD_SOT_ID: {
       this->cs = (data >> SPI_CMD_SOT_CS_OFFSET) & ((1<<SPI_CMD_SOT_CS_WIDTH)-1);
       trace.msg("Handling command SOT (cs: %d)\n", this->cs);
-      if (!periph->qspim_itf.is_bound())
+      if (periph->tlm_active())
+      {
+        periph->tlm_cs = this->cs;
+        periph->tlm_buffer.clear();
+        periph->tlm_tx_bits = 0;
+        periph->tlm_dummy_cycles = 0;
+        periph->tlm_cycles = 0;
+      }
+      else if (!periph->qspim_itf.is_bound())
         periph->trace.force_warning("Trying to set chip select to unbound QSPIM interface\n");
       else
         periph->qspim_itf.cs_sync(this->cs, 1);
@@ -493,6 +662,8 @@ void Spim_v3_cmd_channel::handle_data(uint32_t data)
     case SPI_CMD_DUMMY_ID: {
       int cycles = (data >> SPI_CMD_DUMMY_CYCLE_OFFSET) & ((1<<SPI_CMD_DUMMY_CYCLE_WIDTH)-1);
       trace.msg("Handling command DUMMY (cycles: %d)\n", cycles);
+      if (this->periph->tlm_active())
+        this->periph->tlm_dummy_cycles += cycles;
       break;
     }
 
@@ -570,6 +741,8 @@ void Spim_v3_cmd_channel::handle_data(uint32_t data)
         this->periph->wordtrans = ((data >> SPI_CMD_FUL_WORDTRANS_OFFSET) & ((1<<SPI_CMD_FUL_WORDTRANS_WIDTH)-1));
         this->periph->lsb_first = ARCHI_REG_FIELD_GET(data, SPI_CMD_FUL_LSBFIRST_OFFSET, 1);
         trace.msg("Handling command FUL DUPLEX (size: %d, lsb_first: %d, qpi: %d, bitsword: %d, wordtrans: %d)\n", size, this->periph->lsb_first, this->periph->qpi, this->periph->bitsword, this->periph->wordtrans);
+        if (this->periph->tlm_active())
+          periph->trace.force_warning("Full-duplex transfers are not supported in transaction-level mode\n");
         this->periph->tx_pending_bits = size*(this->periph->bitsword+1);
 
         this->periph->spi_rx_pending_bits = size*(this->periph->bitsword+1);
@@ -609,6 +782,13 @@ void Spim_v3_cmd_channel::handle_data(uint32_t data)
         handled_all = false;
         this->periph->waiting_tx_flush = true;
       }
+      else if (this->periph->tlm_active() && this->periph->tlm_tx_bits > 0)
+      {
+        // Transaction with no RX phase, send it now and handle the EOT again once it is done
+        handled_all = false;
+        this->periph->waiting_tx_flush = true;
+        this->periph->tlm_transfer(0);
+      }
       else
       {
         this->handle_eot(cs_keep);
@@ -117,6 +117,15 @@ private:
 
 
 
+/*
+ * In transaction-level mode, the SPI pads are not used and each SPI transaction is exchanged
+ * in one call with the model bound to the spim<N>_tlm IO port. The request data contains the
+ * bytes shifted out on the bus (command, address and TX data phases, MSB first), followed by
+ * room for the bytes to be shifted in during the RX data phase, which the model must fill.
+ * Arguments 0, 1 and 2 give the number of TX bits, the number of RX bits and the number of
+ * dummy cycles, and argument 3 the chip select. The request is a write if there is no RX phase.
+ * The transaction takes one clock divider period per bus cycle, plus the request latency.
+ */
 class Spim_periph_v3 : public Udma_periph
 {
   friend class Spim_v3_cmd_channel;
@@ -132,8 +141,13 @@ public:
   void check_state();
   bool push_tx_to_spi(uint32_t value, int nb_bits, int qpi, int lsb_first, int bitsword, int wordtrans);
   bool push_rx_to_spi(int nb_bits, int qpi, int lsb_first, int bitsword, int wordtrans);
+  bool tlm_active() { return this->tlm_itf.is_bound(); }
 
 protected:
+  void tlm_push_tx(uint32_t value, int nb_bits, int qpi, int lsb_first, int bitsword, int wordtrans);
+  void tlm_transfer(int rx_bits);
+  static void handle_tlm_end(vp::Block *__this, vp::ClockEvent *event);
+
   vp::Trace trace;
   vp::ClockEvent *pending_spi_word_event;
 
@@ -179,6 +193,17 @@ protected:
   int      tx_counter_bits;
   int      tx_counter_transf;
 
+  // Transaction-level mode
+  vp::IoMaster tlm_itf;
+  vp::IoReq *tlm_req;
+  vp::ClockEvent *tlm_end_event;
+  std::vector<uint8_t> tlm_buffer;  // Bits shifted out since start of transaction, then RX bytes
+  int      tlm_tx_bits;
+  int      tlm_dummy_cycles;
+  int64_t  tlm_cycles;              // Bus cycles of the current transaction
+  int      tlm_cs;
+  std::vector<uint32_t> tlm_rx_words;
+
 };
 
 #endif
\ No newline at end of file
@@ -20,6 +20,10 @@
  */
 
 
+#include <fcntl.h>
+#include <unistd.h>
+#include <errno.h>
+#include <poll.h>
 #include "../udma_impl.hpp"
 #include "../archi/udma_uart_v1.h"
 #include "../archi/utils.h"
@@ -38,6 +42,104 @@ Uart_periph_v1::Uart_periph_v1(udma *top, int id, int itf_id) : Udma_periph(top,
   top->new_master_port(itf_name, &uart_itf, (vp::Block *)this);
 
   uart_itf.set_sync_meth(&Uart_periph_v1::rx_sync);
+
+  this->host_rx_fd = -1;
+  this->host_tx_fd = -1;
+
+  js::Config *config = this->top->get_js_config()->get("uart/host");
+  if (config && itf_id < (int)config->get_elems().size())
+    this->open_host(config->get_elem(itf_id)->get_str());
+}
+
+
+/*
+ * In host mode, the UART pads are not used and whole bytes are exchanged with a host file
+ * descriptor, with one event per buffer. The host is either "stdio", a single path opened for
+ * both directions, like a pty or a fifo, or "<rx path>:<tx path>", where one side can be empty.
+ * An empty string, or no entry for this interface, keeps the bit-level interface.
+ * Stdin is shared with the shell, so its flags are left untouched and it is only polled.
+ */
+void Uart_periph_v1::open_host(std::string host)
+{
+  std::string rx_path = host, tx_path = host;
+
+  if (host == "")
+    return;
+
+  if (host == "stdio")
+  {
+    this->host_rx_fd = 0;
+    this->host_tx_fd = 1;
+  }
+  else
+  {
+    size_t pos = host.find(':');
+    if (pos == std::string::npos)
+    {
+      this->host_rx_fd = this->host_tx_fd = open(host.c_str(), O_RDWR | O_NONBLOCK);
+    }
+    else
+    {
+      rx_path = host.substr(0, pos);
+      tx_path = host.substr(pos + 1);
+      if (rx_path != "")
+        this->host_rx_fd = open(rx_path.c_str(), O_RDONLY | O_NONBLOCK);
+      if (tx_path != "")
+        this->host_tx_fd = open(tx_path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    }
+  }
+
+  if ((rx_path != "" && this->host_rx_fd == -1) || (tx_path != "" && this->host_tx_fd == -1))
+  {
+    this->trace.force_warning("Unable to open UART host (path: %s)\n", host.c_str());
+  }
+}
+
+
+/* Tells if reading the host will not block */
+bool Uart_periph_v1::host_read_ready()
+{
+  struct pollfd fd;
+  fd.fd = this->host_rx_fd;
+  fd.events = POLLIN;
+  return poll(&fd, 1, 0) > 0;
+}
+
+
+/* Writes the whole buffer, waiting for the host when it cannot take more */
+bool Uart_periph_v1::host_write(uint8_t *data, int size)
+{
+  while (size > 0)
+  {
+    int written = write(this->host_tx_fd, data, size);
+    if (written == -1)
+    {
+      if (errno == EAGAIN || errno == EWOULDBLOCK)
+      {
+        struct pollfd fd;
+        fd.fd = this->host_tx_fd;
+        fd.events = POLLOUT;
+        poll(&fd, 1, -1);
+      }
+      else if (errno != EINTR)
+      {
+        return false;
+      }
+      continue;
+    }
+    data += written;
+    size -= written;
+  }
+  return true;
+}
+
+
+/* Cycles taken to transfer a number of bytes, with start, parity and stop bits */
+int64_t Uart_periph_v1::get_frames_cycles(int nb_bytes)
+{
+  int nb_frames = (nb_bytes * 8 + this->bit_length - 1) / this->bit_length;
+  int frame_bits = 1 + this->bit_length + (this->parity ? 1 : 0) + this->stop_bits;
+  return (int64_t)nb_frames * frame_bits * (this->clkdiv + 2);
 }
  
 
@@ -145,6 +247,7 @@ Uart_tx_channel::Uart_tx_channel(udma *top, Uart_periph_v1 *periph, int id, stri
 : Udma_tx_channel(top, id, name), periph(periph)
 {
   pending_word_event = top->event_new((vp::Block *)this, Uart_tx_channel::handle_pending_word);
+  host_tx_event = top->event_new((vp::Block *)this, Uart_tx_channel::handle_host_tx);
 }
 
 
@@ -247,8 +350,49 @@ void Uart_tx_channel::check_state()
 
 
 
+void Uart_tx_channel::handle_host_tx(vp::Block *__this, vp::ClockEvent *event)
+{
+  Uart_tx_channel *_this = (Uart_tx_channel *)__this;
+
+  for (vp::IoReq *req: _this->host_tx_reqs)
+  {
+    if (_this->periph->tx)
+    {
+      if (!_this->periph->host_write(req->get_data(), req->get_actual_size()))
+      {
+        _this->top->get_trace()->warning("Failed to write to UART host\n");
+      }
+    }
+    _this->handle_ready_req_end(req);
+  }
+  _this->host_tx_reqs.clear();
+
+  _this->handle_ready_reqs();
+}
+
+
+
 void Uart_tx_channel::handle_ready_reqs()
 {
+  if (this->periph->host_tx_fd != -1)
+  {
+    // Send everything ready as one buffer, which is written when its last frame is sent
+    if (this->host_tx_reqs.size() == 0 && !ready_reqs->is_empty())
+    {
+      int size = 0;
+      while (!ready_reqs->is_empty())
+      {
+        vp::IoReq *req = this->ready_reqs->pop();
+        size += req->get_actual_size();
+        this->host_tx_reqs.push_back(req);
+      }
+
+      this->top->get_trace()->msg("Sending buffer to host (size: %d)\n", size);
+      top->get_periph_clock()->enqueue(host_tx_event, this->periph->get_frames_cycles(size));
+    }
+    return;
+  }
+
   if (this->pending_bits == 0 && !ready_reqs->is_empty())
   {
     vp::IoReq *req = this->ready_reqs->pop();
@@ -272,6 +416,7 @@ void Uart_tx_channel::reset(bool active)
     this->sent_bits = 0;
     this->pending_bits = 0;
     this->stop_bits = 0;
+    this->host_tx_reqs.clear();
   }
 }
 
@@ -279,12 +424,13 @@ void Uart_tx_channel::reset(bool active)
 
 bool Uart_tx_channel::is_busy()
 {
-  return this->pending_bits != 0 || !ready_reqs->is_empty();
+  return this->pending_bits != 0 || !ready_reqs->is_empty() || this->host_tx_reqs.size() != 0;
 }
 
 
 Uart_rx_channel::Uart_rx_channel(udma *top, Uart_periph_v1 *periph, int id, string name) : Udma_rx_channel(top, id, name), periph(periph)
 {
+  host_rx_event = top->event_new((vp::Block *)this, Uart_rx_channel::handle_host_rx);
 }
 
 void Uart_rx_channel::reset(bool active)
@@ -295,6 +441,58 @@ void Uart_rx_channel::reset(bool active)
   {
     this->state = UART_RX_STATE_WAIT_START;
     this->nb_received_bits = 0;
+    this->host_rx_buffer.clear();
+  }
+}
+
+void Uart_rx_channel::handle_ready()
+{
+  // Host is only polled while there is a transfer to receive the bytes
+  if (this->periph->host_rx_fd != -1 && !this->host_rx_event->is_enqueued())
+  {
+    top->get_periph_clock()->enqueue(this->host_rx_event, 1);
+  }
+}
+
+void Uart_rx_channel::handle_host_rx(vp::Block *__this, vp::ClockEvent *event)
+{
+  Uart_rx_channel *_this = (Uart_rx_channel *)__this;
+  int bit_length = _this->periph->bit_length;
+
+  if (_this->host_rx_buffer.size() > 0)
+  {
+    // Place the bits as the bit-level path does
+    for (uint8_t &byte: _this->host_rx_buffer)
+    {
+      byte = (byte & ((1 << bit_length) - 1)) << (8 - bit_length);
+    }
+    _this->push_data(_this->host_rx_buffer.data(), _this->host_rx_buffer.size());
+    _this->host_rx_buffer.clear();
+  }
+
+  if (_this->current_cmd == NULL || !_this->periph->rx)
+    return;
+
+  // Read at most what the transfer can take, and push it once its frames are received
+  int size = 0;
+  if (_this->periph->host_read_ready())
+  {
+    _this->host_rx_buffer.resize(_this->current_cmd->remaining_size - _this->pending_byte_index);
+    size = read(_this->periph->host_rx_fd, _this->host_rx_buffer.data(), _this->host_rx_buffer.size());
+    if (size < 0)
+      size = 0;
+  }
+  _this->host_rx_buffer.resize(size);
+
+  if (size > 0)
+  {
+    _this->top->get_trace()->msg("Received buffer from host (size: %d)\n", size);
+    _this->top->get_periph_clock()->enqueue(event, _this->periph->get_frames_cycles(size));
+  }
+  else
+  {
+    // Nothing available, poll again later
+    _this->top->get_periph_clock()->enqueue(event, _this->periph->get_frames_cycles(64));
   }
 }
 
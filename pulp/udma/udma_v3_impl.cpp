@@ -43,39 +43,61 @@
 
 
 
+Udma_rx_channel::Udma_rx_channel(udma *top, int id, string name) : Udma_channel(top, id, name)
+{
+  this->pending_data = new uint8_t[top->get_l2_write_burst_size()];
+}
+
 void Udma_rx_channel::push_data(uint8_t *data, int size)
 {
-  if (current_cmd == NULL)
+  while (size > 0)
   {
-    //top->warning.warning("Received data while there is no ready command\n");
-    return;
-  }
+    if (current_cmd == NULL)
+    {
+      //top->warning.warning("Received data while there is no ready command\n");
+      return;
+    }
 
-  if (size + this->pending_byte_index > 4)
-  {
-    trace.force_warning("Trying to push more than 4 bytes from peripheral to udma core\n");
-    return;
-  }
+    // Bursts never cross a burst-aligned boundary and stop exactly at the end of the transfer
+    int burst_size = this->top->get_l2_write_burst_size();
+    int limit = burst_size - (current_cmd->current_addr & (burst_size - 1));
+    if (limit > current_cmd->remaining_size)
+      limit = current_cmd->remaining_size;
 
-  memcpy(&(((uint8_t *)&this->pending_word)[this->pending_byte_index]), data, size);
+    int copy_size = limit - this->pending_byte_index;
+    if (copy_size > size)
+      copy_size = size;
 
-  this->pending_byte_index += size;
+    memcpy(&this->pending_data[this->pending_byte_index], data, copy_size);
 
-  if (this->pending_byte_index >= 4 || this->pending_byte_index >= current_cmd->remaining_size)
-  {
-    this->pending_byte_index = 0;
-    vp::IoReq *req = this->top->l2_itf.req_new(0, new uint8_t[4], 4, true);
-    *(uint32_t *)req->get_data() = this->pending_word;
-    bool end = current_cmd->prepare_req(req);
-    trace.msg("Writing 4 bytes to memory (value: 0x%x, addr: 0x%x)\n", this->pending_word, req->get_addr());
-    this->top->push_l2_write_req(req);
-    if (end)
+    this->pending_byte_index += copy_size;
+    data += copy_size;
+    size -= copy_size;
+
+    if (this->pending_byte_index >= limit)
     {
-      handle_transfer_end();
+      this->flush_data();
     }
   }
 }
 
+void Udma_rx_channel::flush_data()
+{
+  int size = this->pending_byte_index;
+  vp::IoReq *req = this->top->get_l2_write_req();
+
+  this->pending_byte_index = 0;
+  memcpy(req->get_data(), this->pending_data, size);
+  bool end = current_cmd->prepare_write_req(req, size);
+  *(Udma_channel **)req->arg_get(0) = this;
+  trace.msg("Writing %d bytes to memory (addr: 0x%x)\n", size, req->get_addr());
+  this->top->push_l2_write_req(req);
+  if (end)
+  {
+    handle_transfer_end();
+  }
+}
+
 void Udma_rx_channel::reset(bool active)
 {
   Udma_channel::reset(active);
@@ -124,9 +146,93 @@ bool Udma_channel::handle_ready_req_end(vp::IoReq *req)
   return end;
 }
 
+vp::IoReq *Udma_channel::get_prefetch_req()
+{
+  int burst_size = top->get_l2_read_burst_size();
+  int burst_words = burst_size / 4;
+
+  if (this->prefetch_bursts == NULL)
+  {
+    int depth = top->get_tx_prefetch_depth();
+    this->prefetch_bursts = new Udma_queue<vp::IoReq>(depth);
+    this->prefetch_words = new Udma_queue<vp::IoReq>(depth * burst_words);
+    for (int i=0; i<depth; i++)
+    {
+      vp::IoReq *req = new vp::IoReq();
+      req->set_data(new uint8_t[burst_size]);
+      req->set_is_write(false);
+      req->arg_alloc(); // Used to store channel;
+      this->prefetch_bursts->push(req);
+    }
+    for (int i=0; i<depth * burst_words; i++)
+    {
+      vp::IoReq *req = new vp::IoReq();
+      req->set_data(new uint8_t[4]);
+      req->set_is_write(false);
+      req->arg_alloc(); // Used to store channel;
+      this->prefetch_words->push(req);
+    }
+    this->prefetch_nb_free_words = depth * burst_words;
+    this->prefetch_blocked = false;
+  }
+
+  if (this->prefetch_bursts->is_empty() || this->prefetch_nb_free_words < burst_words)
+  {
+    trace.msg("TX prefetch buffer is full\n");
+    this->prefetch_blocked = true;
+    return NULL;
+  }
+
+  this->prefetch_nb_free_words -= burst_words;
+  return this->prefetch_bursts->pop();
+}
+
+void Udma_channel::push_prefetch_burst(vp::IoReq *req)
+{
+  int size = req->get_size();
+  int valid_size = req->get_actual_size();
+
+  trace.msg("Received burst from L2 (addr: 0x%x, size: 0x%x)\n", req->get_addr(), size);
+
+  // Give back the words reserved for a full burst that this one does not use
+  this->prefetch_nb_free_words += (top->get_l2_read_burst_size() - size) / 4;
+
+  for (int offset=0; offset<size; offset+=4)
+  {
+    vp::IoReq *word = this->prefetch_words->pop();
+    word->prepare();
+    word->set_addr(req->get_addr() + offset);
+    word->set_size(4);
+    word->set_actual_size(valid_size - offset > 4 ? 4 : valid_size - offset);
+    *(Udma_channel **)word->arg_get(0) = this;
+    memcpy(word->get_data(), req->get_data() + offset, 4);
+
+    this->push_ready_req(word);
+  }
+
+  this->prefetch_bursts->push(req);
+}
+
+bool Udma_channel::free_prefetch_word(vp::IoReq *req)
+{
+  this->prefetch_words->push(req);
+  this->prefetch_nb_free_words++;
+
+  // Tell the caller when the channel can issue bursts again
+  if (this->prefetch_blocked && !this->prefetch_bursts->is_empty() &&
+    this->prefetch_nb_free_words >= top->get_l2_read_burst_size() / 4)
+  {
+    this->prefetch_blocked = false;
+    return true;
+  }
+
+  return false;
+}
+
 void Udma_channel::push_ready_req(vp::IoReq *req)
 {
   current_cmd->received_size += req->get_size();
+  this->stats_bytes += req->get_actual_size();
 
   trace.msg("Received data from L2 (cmd: %p, data_size: 0x%x, transfer_size: 0x%x, received_size: 0x%x, value: 0x%x)\n",
     current_cmd, req->get_size(), current_cmd->size, current_cmd->received_size, *(uint32_t *)req->get_data());
@@ -305,6 +411,28 @@ Udma_channel::Udma_channel(udma *top, int id, string name) : top(top), id(id), n
   event = top->event_new((vp::Block *)this, udma::channel_handler);
 
   top->traces.new_trace_event(name + "/state", &this->state_event, 8);
+  top->traces.new_trace_event(name + "/bytes", &this->bytes_event, 32);
+}
+
+
+
+/* Called for each request sent to L2, with the number of bytes it carries for this channel */
+void Udma_channel::stats_account_l2_req(int size, int64_t latency)
+{
+  uint32_t value = size;
+  this->bytes_event.event((uint8_t *)&value);
+  this->stats_l2_reqs++;
+  this->stats_l2_latency += latency;
+}
+
+
+
+void Udma_channel::stats_report()
+{
+  top->stats_trace.msg(vp::Trace::LEVEL_INFO, "%-16s %12ld %12ld %12.2f %12ld\n", this->name.c_str(),
+    this->stats_bytes, this->stats_l2_reqs,
+    this->stats_l2_reqs ? (double)this->stats_l2_latency / this->stats_l2_reqs : 0.0,
+    this->stats_starved_cycles);
 }
 
 
@@ -324,6 +452,11 @@ void Udma_channel::reset(bool active)
     continuous_mode = 0;
     transfer_size = 0;
     this->state_event.event(NULL);
+    this->stats_bytes = 0;
+    this->stats_l2_reqs = 0;
+    this->stats_l2_latency = 0;
+    this->stats_starved_cycles = 0;
+    this->ready_cycle = -1;
   }
 }
 
@@ -348,6 +481,18 @@ void Udma_periph::clock_gate(bool new_is_on)
 
 
 
+void Udma_periph::stats_report()
+{
+  if (channel0)
+    channel0->stats_report();
+  if (channel1)
+    channel1->stats_report();
+  if (channel2)
+    channel2->stats_report();
+}
+
+
+
 void Udma_periph::reset(bool active)
 {
   if (active)
@@ -444,6 +589,40 @@ bool Udma_transfer::prepare_req(vp::IoReq *req)
   return remaining_size <= 0;
 }
 
+bool Udma_transfer::prepare_burst_req(vp::IoReq *req, int burst_size)
+{
+  // Bursts never cross a burst-aligned boundary and, as for single words, always read full
+  // words, the actual size giving the number of valid bytes
+  int size = burst_size - (current_addr & (burst_size - 1));
+  int aligned_remaining = (remaining_size + 3) & ~3;
+  if (size > aligned_remaining)
+    size = aligned_remaining;
+
+  req->prepare();
+  req->set_addr(current_addr);
+  req->set_size(size);
+  req->set_actual_size(remaining_size > size ? size : remaining_size);
+
+  *(Udma_channel **)req->arg_get(0) = channel;
+
+  current_addr += size;
+  remaining_size -= size;
+
+  return remaining_size <= 0;
+}
+
+bool Udma_transfer::prepare_write_req(vp::IoReq *req, int size)
+{
+  req->prepare();
+  req->set_addr(current_addr);
+  req->set_size(size);
+
+  current_addr += size;
+  remaining_size -= size;
+
+  return remaining_size <= 0;
+}
+
 void udma::trigger_event(int event)
 {
   trace.msg("Triggering event (event: %d)\n", event);
@@ -455,6 +634,9 @@ udma::udma(vp::ComponentConf &config)
 : vp::Component(config)
 {
   traces.new_trace("trace", &trace, vp::DEBUG);
+  traces.new_trace("stats", &stats_trace, vp::DEBUG);
+  traces.new_trace_event("read_fifo", &read_fifo_event, 8);
+  traces.new_trace_event("write_queue", &write_queue_event, 8);
 
   in.set_req_meth(&udma::req);
   new_slave_port("input", &in);
@@ -467,6 +649,40 @@ udma::udma(vp::ComponentConf &config)
 
   l2_read_fifo_size = get_js_config()->get_child_int("properties/l2_read_fifo_size");
 
+  // RX data is gathered into bursts of this size before being written to L2, which must be
+  // a power of 2. Default is one 32 bits word per request.
+  js::Config *burst_config = get_js_config()->get("properties/l2_write_burst_size");
+  l2_write_burst_size = burst_config ? burst_config->get_int() : 4;
+  if (l2_write_burst_size < 4 || (l2_write_burst_size & (l2_write_burst_size - 1)))
+  {
+    throw logic_error("Invalid L2 write burst size: " + std::to_string(l2_write_burst_size));
+  }
+
+  // TX channels can prefetch L2 data with bursts of this size, up to the given number of
+  // bursts per channel. With the default burst size of 4, the shared L2 read FIFO is used.
+  js::Config *read_burst_config = get_js_config()->get("properties/l2_read_burst_size");
+  l2_read_burst_size = read_burst_config ? read_burst_config->get_int() : 4;
+  if (l2_read_burst_size < 4 || (l2_read_burst_size & (l2_read_burst_size - 1)))
+  {
+    throw logic_error("Invalid L2 read burst size: " + std::to_string(l2_read_burst_size));
+  }
+  js::Config *prefetch_config = get_js_config()->get("properties/tx_prefetch_depth");
+  tx_prefetch_depth = prefetch_config ? prefetch_config->get_int() : 2;
+  if (tx_prefetch_depth < 1)
+  {
+    throw logic_error("Invalid TX prefetch depth: " + std::to_string(tx_prefetch_depth));
+  }
+
+  // Width of the L2 port, in number of read and write requests which can be sent per cycle
+  js::Config *reads_config = get_js_config()->get("properties/l2_read_reqs_per_cycle");
+  l2_read_reqs_per_cycle = reads_config ? reads_config->get_int() : 1;
+  js::Config *writes_config = get_js_config()->get("properties/l2_write_reqs_per_cycle");
+  l2_write_reqs_per_cycle = writes_config ? writes_config->get_int() : 1;
+  if (l2_read_reqs_per_cycle < 1 || l2_write_reqs_per_cycle < 1)
+  {
+    throw logic_error("Invalid number of L2 requests per cycle");
+  }
+
   l2_itf.set_resp_meth(&udma::l2_response);
   l2_itf.set_grant_meth(&udma::l2_grant);
   new_master_port("l2_itf", &l2_itf);
@@ -477,6 +693,7 @@ udma::udma(vp::ComponentConf &config)
 
   l2_read_reqs = new Udma_queue<vp::IoReq>(l2_read_fifo_size);
   l2_write_reqs = new Udma_queue<vp::IoReq>(0);
+  l2_write_free_reqs = new Udma_queue<vp::IoReq>(0);
   l2_read_waiting_reqs = new Udma_queue<vp::IoReq>(l2_read_fifo_size);
   for (int i=0; i<l2_read_fifo_size; i++)
   {
@@ -664,11 +881,75 @@ udma::udma(vp::ComponentConf &config)
 
 void udma::push_l2_write_req(vp::IoReq *req)
 {
+  *(int64_t *)req->arg_get(1) = this->clock.get_cycles();
   this->l2_write_reqs->push(req);
+  this->stats_fifo_update();
   this->check_state();
 }
 
 
+void udma::push_ready_tx_channel(Udma_channel *channel)
+{
+  channel->ready_cycle = this->clock.get_cycles();
+  this->ready_tx_channels->push(channel);
+}
+
+
+void udma::stats_fifo_update()
+{
+  // With bursts, the read FIFO is replaced by the channel prefetch buffers, so only count
+  // the requests in flight
+  uint8_t value = this->l2_read_burst_size > 4 ? this->l2_read_waiting_reqs->get_nb_cmd() :
+    this->l2_read_fifo_size - this->l2_read_reqs->get_nb_cmd();
+  this->read_fifo_event.event(&value);
+  if (value > this->stats_read_fifo_max)
+    this->stats_read_fifo_max = value;
+
+  value = this->l2_write_reqs->get_nb_cmd();
+  this->write_queue_event.event(&value);
+  if (value > this->stats_write_queue_max)
+    this->stats_write_queue_max = value;
+}
+
+
+void udma::stop()
+{
+  this->stats_trace.msg(vp::Trace::LEVEL_INFO, "%-16s %12s %12s %12s %12s\n", "channel", "bytes", "l2_reqs",
+    "avg_latency", "starved");
+
+  for (int i=0; i<this->nb_periphs; i++)
+  {
+    if (this->periphs[i] != NULL && this->periphs[i]->id == i)
+      this->periphs[i]->stats_report();
+  }
+
+  this->stats_trace.msg(vp::Trace::LEVEL_INFO, "L2 read FIFO (size: %d, max occupancy: %d, ran dry: %ld times for %ld cycles)\n",
+    this->l2_read_fifo_size, this->stats_read_fifo_max, this->stats_read_fifo_dry, this->stats_read_fifo_dry_cycles);
+  this->stats_trace.msg(vp::Trace::LEVEL_INFO, "L2 write queue (max occupancy: %d)\n", this->stats_write_queue_max);
+  this->stats_trace.msg(vp::Trace::LEVEL_INFO, "L2 port (reads/cycle: %d, limited cycles: %ld, writes/cycle: %d, limited cycles: %ld)\n",
+    this->l2_read_reqs_per_cycle, this->stats_read_limited_cycles, this->l2_write_reqs_per_cycle,
+    this->stats_write_limited_cycles);
+}
+
+
+vp::IoReq *udma::get_l2_write_req()
+{
+  // Write requests are recycled once sent, so new ones are only allocated until there are
+  // enough of them to cover the write requests in flight
+  if (!this->l2_write_free_reqs->is_empty())
+  {
+    return this->l2_write_free_reqs->pop();
+  }
+
+  vp::IoReq *req = new vp::IoReq();
+  req->set_data(new uint8_t[this->l2_write_burst_size]);
+  req->set_is_write(true);
+  req->arg_alloc(); // Used to store channel;
+  req->arg_alloc(); // Used to store the cycle where it is queued
+  return req;
+}
+
+
 void udma::channel_handler(vp::Block *__this, vp::ClockEvent *event)
 {
   Udma_channel *channel = (Udma_channel *)__this;
@@ -680,54 +961,132 @@ void udma::channel_handler(vp::Block *__this, vp::ClockEvent *event)
 void udma::enqueue_ready(Udma_channel *channel)
 {
   if (channel->is_tx())
-    ready_tx_channels->push(channel);
+  {
+    // A channel waiting for room in its prefetch buffer is pushed once it gets some
+    if (!channel->is_prefetch_blocked())
+      push_ready_tx_channel(channel);
+  }
   else
     channel->handle_ready();
 
   check_state();
 }
 
-void udma::event_handler(vp::Block *__this, vp::ClockEvent *event)
+void udma::send_l2_write()
 {
-  udma *_this = (udma *)__this;
+  vp::IoReq *req = this->l2_write_reqs->pop();
+  this->trace.msg("Sending write request to L2 (value: 0x%x, addr: 0x%x, size: 0x%x)\n", *(uint32_t *)req->get_data(), req->get_addr(), req->get_size());
+  int err = this->l2_itf.req(req);
+  if (err == vp::IO_REQ_OK)
+  {
+    Udma_channel *channel = *(Udma_channel **)req->arg_get(0);
+    int64_t wait = this->clock.get_cycles() - *(int64_t *)req->arg_get(1);
+    channel->stats_bytes += req->get_size();
+    channel->stats_account_l2_req(req->get_size(), wait + req->get_latency());
+    this->l2_write_free_reqs->push(req);
+  }
+  else
+  {
+    this->trace.warning("UNIMPLEMENTED AT %s %d\n", __FILE__, __LINE__);
+  }
+}
 
-  if (!_this->l2_write_reqs->is_empty())
+void udma::send_l2_read()
+{
+  if (this->l2_read_burst_size > 4)
   {
-    vp::IoReq *req = _this->l2_write_reqs->pop();
-    _this->trace.msg("Sending write request to L2 (value: 0x%x, addr: 0x%x, size: 0x%x)\n", *(uint32_t *)req->get_data(), req->get_addr(), req->get_size());
-    int err = _this->l2_itf.req(req);
-    if (err == vp::IO_REQ_OK)
-    {
-    }
-    else
+    if (!this->ready_tx_channels->is_empty())
     {
-      _this->trace.warning("UNIMPLEMENTED AT %s %d\n", __FILE__, __LINE__);
-    }
+      // Channels with a full prefetch buffer are not pushed back, they will be when
+      // the peripheral consumes data
+      Udma_channel *channel = this->ready_tx_channels->pop();
+      channel->stats_starved_cycles += this->clock.get_cycles() - channel->ready_cycle;
+      vp::IoReq *req = channel->get_prefetch_req();
+      if (req != NULL)
+      {
+        if (!channel->current_cmd->prepare_burst_req(req, this->l2_read_burst_size))
+        {
+          this->push_ready_tx_channel(channel);
+        }
 
+        this->trace.msg("Sending burst read request to L2 (addr: 0x%x, size: 0x%x)\n", req->get_addr(), req->get_size());
+        int err = this->l2_itf.req(req);
+        if (err == vp::IO_REQ_OK)
+        {
+          channel->stats_account_l2_req(req->get_actual_size(), req->get_latency() + 1);
+          req->set_latency(req->get_latency() + this->clock.get_cycles() + 1);
+          this->l2_read_waiting_reqs->push_from_latency(req);
+        }
+        else
+        {
+          this->trace.warning("UNIMPLEMENTED AT %s %d\n", __FILE__, __LINE__);
+        }
+      }
+    }
   }
-
-  if (!_this->ready_tx_channels->is_empty() && !_this->l2_read_reqs->is_empty())
+  else if (!this->ready_tx_channels->is_empty() && !this->l2_read_reqs->is_empty())
   {
-    vp::IoReq *req = _this->l2_read_reqs->pop();
-    Udma_channel *channel = _this->ready_tx_channels->pop();
+    vp::IoReq *req = this->l2_read_reqs->pop();
+    if (this->l2_read_reqs->is_empty())
+    {
+      this->stats_read_fifo_dry++;
+      this->read_fifo_dry_start = this->clock.get_cycles();
+    }
+    Udma_channel *channel = this->ready_tx_channels->pop();
+    channel->stats_starved_cycles += this->clock.get_cycles() - channel->ready_cycle;
     if (!channel->prepare_req(req))
     {
-      _this->ready_tx_channels->push(channel);
+      this->push_ready_tx_channel(channel);
     }
 
-    _this->trace.msg("Sending read request to L2 (addr: 0x%x, size: 0x%x)\n", req->get_addr(), req->get_size());
-    int err = _this->l2_itf.req(req);
+    this->trace.msg("Sending read request to L2 (addr: 0x%x, size: 0x%x)\n", req->get_addr(), req->get_size());
+    int err = this->l2_itf.req(req);
     if (err == vp::IO_REQ_OK)
     {
-      _this->trace.msg("Read FIFO received word from L2 (value: 0x%x)\n", *(uint32_t *)req->get_data());
-      req->set_latency(req->get_latency() + _this->clock.get_cycles() + 1);
-      _this->l2_read_waiting_reqs->push_from_latency(req);
+      channel->stats_account_l2_req(req->get_actual_size(), req->get_latency() + 1);
+      this->trace.msg("Read FIFO received word from L2 (value: 0x%x)\n", *(uint32_t *)req->get_data());
+      req->set_latency(req->get_latency() + this->clock.get_cycles() + 1);
+      this->l2_read_waiting_reqs->push_from_latency(req);
     }
     else
     {
-      _this->trace.warning("UNIMPLEMENTED AT %s %d\n", __FILE__, __LINE__);
+      this->trace.warning("UNIMPLEMENTED AT %s %d\n", __FILE__, __LINE__);
     }
   }
+}
+
+bool udma::can_send_l2_read()
+{
+  return !ready_tx_channels->is_empty() && (l2_read_burst_size > 4 || !l2_read_reqs->is_empty());
+}
+
+void udma::event_handler(vp::Block *__this, vp::ClockEvent *event)
+{
+  udma *_this = (udma *)__this;
+
+  // Up to the L2 port width, write requests are sent in order of arrival and ready TX
+  // channels are served in round-robin, each one being pushed back to the end of the queue
+  for (int i=0; i<_this->l2_write_reqs_per_cycle && !_this->l2_write_reqs->is_empty(); i++)
+  {
+    _this->send_l2_write();
+  }
+
+  if (!_this->l2_write_reqs->is_empty())
+  {
+    _this->trace.msg("L2 writes limited by port width (pending: %d)\n", _this->l2_write_reqs->get_nb_cmd());
+    _this->stats_write_limited_cycles++;
+  }
+
+  for (int i=0; i<_this->l2_read_reqs_per_cycle && _this->can_send_l2_read(); i++)
+  {
+    _this->send_l2_read();
+  }
+
+  if (_this->can_send_l2_read())
+  {
+    _this->trace.msg("L2 reads limited by port width\n");
+    _this->stats_read_limited_cycles++;
+  }
 
   vp::IoReq *req = _this->l2_read_waiting_reqs->get_first();
   while (req != NULL && req->get_latency() <= _this->clock.get_cycles())
@@ -736,24 +1095,40 @@ void udma::event_handler(vp::Block *__this, vp::ClockEvent *event)
 
     Udma_channel *channel = *(Udma_channel **)req->arg_get(0);
     _this->l2_read_waiting_reqs->pop();
-    channel->push_ready_req(req);
+    if (_this->l2_read_burst_size > 4)
+      channel->push_prefetch_burst(req);
+    else
+      channel->push_ready_req(req);
 
     req = _this->l2_read_waiting_reqs->get_first();
   }
 
+  _this->stats_fifo_update();
   _this->check_state();
 }
 
 
 void udma::free_read_req(vp::IoReq *req)
 {
-  l2_read_reqs->push(req);
+  if (l2_read_burst_size > 4)
+  {
+    Udma_channel *channel = *(Udma_channel **)req->arg_get(0);
+    if (channel->free_prefetch_word(req))
+      push_ready_tx_channel(channel);
+  }
+  else
+  {
+    if (l2_read_reqs->is_empty())
+      stats_read_fifo_dry_cycles += clock.get_cycles() - read_fifo_dry_start;
+    l2_read_reqs->push(req);
+  }
+  stats_fifo_update();
   check_state();
 }
 
 void udma::check_state()
 {
-  if ((!ready_tx_channels->is_empty() && !l2_read_reqs->is_empty()) || !l2_write_reqs->is_empty())
+  if (can_send_l2_read() || !l2_write_reqs->is_empty())
   {
     //printf("Enqueue 1 cycles\n");
     event_reenqueue_ext(event, 1);
@@ -873,6 +1248,12 @@ void udma::reset(bool active)
   if (active)
   {
     clock_gating = 0;
+    stats_read_fifo_max = 0;
+    stats_write_queue_max = 0;
+    stats_read_fifo_dry = 0;
+    stats_read_fifo_dry_cycles = 0;
+    stats_read_limited_cycles = 0;
+    stats_write_limited_cycles = 0;
   }
 
   for (int i=0; i<nb_periphs; i++)
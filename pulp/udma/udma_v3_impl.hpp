@@ -63,6 +63,8 @@ public:
   Udma_channel *channel;
 
   bool prepare_req(vp::IoReq *req);
+  bool prepare_write_req(vp::IoReq *req, int size);
+  bool prepare_burst_req(vp::IoReq *req, int burst_size);
   void set_next(Udma_transfer *next) { this->next = next; }
   Udma_transfer *get_next() { return next; }
   Udma_transfer *next;
@@ -81,6 +83,7 @@ public:
   void push_from_latency(T *cmd);
   bool is_full() { return nb_cmd >= size; }
   bool is_empty() { return nb_cmd == 0; }
+  int get_nb_cmd() { return nb_cmd; }
   T *get_first() { return first; }
 
 private:
@@ -114,6 +117,20 @@ public:
 
   void build_reqs_and_enqueue(Udma_transfer *current_req);
 
+  vp::IoReq *get_prefetch_req();
+  void push_prefetch_burst(vp::IoReq *req);
+  bool free_prefetch_word(vp::IoReq *req);
+  bool is_prefetch_blocked() { return this->prefetch_bursts != NULL && this->prefetch_blocked; }
+
+  void stats_report();
+  void stats_account_l2_req(int size, int64_t latency);
+
+  int64_t stats_bytes;            // Bytes exchanged with L2
+  int64_t stats_l2_reqs;
+  int64_t stats_l2_latency;       // Sum of L2 request latencies, including time spent in uDMA queues
+  int64_t stats_starved_cycles;   // Cycles spent waiting for an L2 read slot while ready
+  int64_t ready_cycle;            // Cycle when the channel was pushed to the ready queue
+
 protected:
   vp::Trace     trace;
   Udma_queue<vp::IoReq> *ready_reqs;
@@ -141,7 +158,15 @@ private:
   Udma_queue<Udma_transfer> *free_reqs;
   Udma_queue<Udma_transfer> *pending_reqs;
 
+  // TX prefetch buffer, used when L2 is read with bursts. Each burst in flight reserves the
+  // words it can contain, which are then handed over one by one to the peripheral.
+  Udma_queue<vp::IoReq> *prefetch_bursts = NULL;
+  Udma_queue<vp::IoReq> *prefetch_words = NULL;
+  int prefetch_nb_free_words;
+  bool prefetch_blocked;
+
   vp::Trace     state_event;
+  vp::Trace     bytes_event;
 };
 
 
@@ -149,15 +174,17 @@ private:
 class Udma_rx_channel : public Udma_channel
 {
 public:
-  Udma_rx_channel(udma *top, int id, string name) : Udma_channel(top, id, name) {}
+  Udma_rx_channel(udma *top, int id, string name);
   bool is_tx() { return false; }
   void reset(bool active);
   void push_data(uint8_t *data, int size);
   bool has_cmd() { return this->current_cmd != NULL; }
 
-private:
+protected:
+  void flush_data();
+
   int pending_byte_index;
-  uint32_t pending_word;
+  uint8_t *pending_data;    // Received bytes being gathered into the next L2 burst
 };
 
 
@@ -215,6 +242,7 @@ public:
   virtual vp::IoReqStatus req(vp::IoReq *req, uint64_t offset);
   virtual void reset(bool active);
   void clock_gate(bool is_on);
+  void stats_report();
 
   int id;
 
@@ -381,15 +409,19 @@ public:
   Uart_rx_channel(udma *top, Uart_periph_v1 *periph, int id, string name);
   bool is_busy();
   void handle_rx_bit(int bit);
+  void handle_ready();
 
 private:
   void reset(bool active);
+  static void handle_host_rx(vp::Block *__this, vp::ClockEvent *event);
   Uart_periph_v1 *periph;
   uart_rx_state_e state;
   int parity;
   int stop_bits;
   uint8_t  pending_rx_byte;
   int nb_received_bits;
+  vp::ClockEvent *host_rx_event;
+  std::vector<uint8_t> host_rx_buffer;  // Bytes read from host, pushed when their frames are received
 };
 
 
@@ -412,10 +444,13 @@ private:
   void reset(bool active);
   void check_state();
   static void handle_pending_word(vp::Block *__this, vp::ClockEvent *event);
+  static void handle_host_tx(vp::Block *__this, vp::ClockEvent *event);
 
   Uart_periph_v1 *periph;
 
   vp::ClockEvent *pending_word_event;
+  vp::ClockEvent *host_tx_event;
+  std::vector<vp::IoReq *> host_tx_reqs;  // Requests being sent to host
 
   uint32_t pending_word;
   int pending_bits;
@@ -445,6 +480,12 @@ public:
   int rx;
   int clkdiv;
   int rx_pe;
+  int host_rx_fd;
+  int host_tx_fd;
+
+  int64_t get_frames_cycles(int nb_bytes);
+  bool host_read_ready();
+  bool host_write(uint8_t *data, int size);
 
 protected:
   vp::UartMaster uart_itf;
@@ -453,6 +494,7 @@ private:
   vp::IoReqStatus status_req(vp::IoReq *req);
   vp::IoReqStatus setup_req(vp::IoReq *req);
   void set_setup_reg(uint32_t value);
+  void open_host(std::string host);
   static void rx_sync(vp::Block *, int data);
 
   uint32_t setup_reg_value;
@@ -489,19 +531,26 @@ public:
 
 protected:
   vp::CpiSlave cpi_itf;
+  vp::IoSlave frame_itf;
 
 private:
   static void sync(vp::Block *__this, int pclk, int href, int vsync, int data);
   static void sync_cycle(vp::Block *__this, int href, int vsync, int data);
+  static vp::IoReqStatus frame_req(vp::Block *__this, vp::IoReq *req);
   vp::IoReqStatus handle_global_access(bool is_write, uint32_t *data);
   vp::IoReqStatus handle_l1_access(bool is_write, uint32_t *data);
   vp::IoReqStatus handle_ur_access(bool is_write, uint32_t *data);
   vp::IoReqStatus handle_size_access(bool is_write, uint32_t *data);
   vp::IoReqStatus handle_filter_access(bool is_write, uint32_t *data);
   void push_pixel(uint32_t pixel);
+  void push_pixels(uint8_t *data, int size);
+  int convert_pixels(uint16_t *pixels, int nb_pixels, uint8_t *out);
 
   vp::Trace     trace;
 
+  std::vector<uint16_t> frame_pixels;
+  std::vector<uint8_t> frame_burst;
+
   int pending_byte;
   bool has_pending_byte;
   bool cmd_ready;
@@ -821,6 +870,15 @@ private:
 
 };
 
+/*
+ * In transaction-level mode, the HyperBus pads are not used and each 1D transfer (a 2D transfer
+ * is still split by transfer_splitter) is exchanged in one call with the model bound to the
+ * hyper<N>_tlm IO port. The request address is the external address, the data is the whole
+ * transfer and arguments 0, 1 and 2 give the chip select, the address space (1 for registers)
+ * and the burst type. The transfer takes one clock divider period per bus cycle (chip select,
+ * 6 command-address bytes, data bytes, chip select release), plus the initial latency and the
+ * request latency.
+ */
 class Hyper_periph_v3 : public Udma_periph
 {
   friend class Hyper_v3_tx_channel;
@@ -849,6 +907,7 @@ public:
   int get_busy_reg(int id);
   void update_nb_tran(int id, int value);
   int get_nb_tran(int id);
+  bool tlm_active() { return this->tlm_itf.is_bound(); }
 
 protected:
   vp::HyperMaster hyper_itf;
@@ -907,6 +966,17 @@ private:
   int channel_id;
   int mem_sel;
 
+  void handle_transfer_end(bool read);
+  void tlm_check_state();
+  void tlm_transfer(bool is_write, int size);
+  static void handle_tlm_end(vp::Block *__this, vp::ClockEvent *event);
+
+  vp::IoMaster tlm_itf;
+  vp::IoReq *tlm_req;
+  vp::ClockEvent *tlm_end_event;
+  std::vector<uint8_t> tlm_buffer;  // Whole transfer data
+  bool tlm_busy;
+  bool tlm_is_write;
 };
 
 
@@ -944,6 +1014,7 @@ T *Udma_queue<T>::pop()
 class udma : public vp::Component
 {
   friend class Udma_periph;
+  friend class Udma_channel;
   friend class Udma_rx_channel;
 
 public:
@@ -951,6 +1022,7 @@ public:
   udma(vp::ComponentConf &config);
 
   void reset(bool active);
+  void stop();
 
   void enqueue_ready(Udma_channel *channel);
 
@@ -965,10 +1037,21 @@ public:
 protected:
   vp::IoMaster l2_itf;
   void push_l2_write_req(vp::IoReq *req);
+  vp::IoReq *get_l2_write_req();
+  int get_l2_write_burst_size() { return this->l2_write_burst_size; }
+
+public:
+  int get_l2_read_burst_size() { return this->l2_read_burst_size; }
+  int get_tx_prefetch_depth() { return this->tx_prefetch_depth; }
 
 private:
 
   void check_state();
+  void send_l2_write();
+  void send_l2_read();
+  bool can_send_l2_read();
+  void push_ready_tx_channel(Udma_channel *channel);
+  void stats_fifo_update();
 
   vp::IoReqStatus conf_req(vp::IoReq *req, uint64_t offset);
   vp::IoReqStatus periph_req(vp::IoReq *req, uint64_t offset);
@@ -985,6 +1068,11 @@ private:
   
   int nb_periphs;
   int l2_read_fifo_size;
+  int l2_write_burst_size;
+  int l2_read_burst_size;
+  int tx_prefetch_depth;
+  int l2_read_reqs_per_cycle;
+  int l2_write_reqs_per_cycle;
   std::vector<Udma_periph *>periphs;
   Udma_queue<Udma_channel> *ready_rx_channels;
   Udma_queue<Udma_channel> *ready_tx_channels;
@@ -992,9 +1080,21 @@ private:
   vp::ClockEvent *event;
   Udma_queue<vp::IoReq> *l2_read_reqs;
   Udma_queue<vp::IoReq> *l2_write_reqs;
+  Udma_queue<vp::IoReq> *l2_write_free_reqs;
   Udma_queue<vp::IoReq> *l2_read_waiting_reqs;
   
   vp::WireMaster<int>    event_itf;
+
+  vp::Trace     stats_trace;
+  vp::Trace     read_fifo_event;
+  vp::Trace     write_queue_event;
+  int stats_read_fifo_max;
+  int stats_write_queue_max;
+  int64_t stats_read_fifo_dry;          // Number of times the L2 read FIFO ran out of requests
+  int64_t stats_read_fifo_dry_cycles;
+  int64_t read_fifo_dry_start;
+  int64_t stats_read_limited_cycles;    // Cycles where more reads could have been sent with a wider port
+  int64_t stats_write_limited_cycles;
 };
 
 